@@ -0,0 +1,335 @@
+#include "Benchmark.hpp"
+
+#include "GLRenderer/Renderer/RendererContext.hpp"
+#include "GLRenderer/Scene/Scene.hpp"
+#include "GLRenderer/Scene/Component.hpp"
+#include "GLRenderer/Lighting/PointLight.hpp"
+#include "GLRenderer/Camera.hpp"
+
+#include "Profiling/Profiler.hpp"
+#include "Profiling/AllocationTracker.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace oryon
+{
+
+Benchmark::Benchmark(const BenchOptions& options)
+	: _options(options)
+{
+
+}
+
+bool Benchmark::Initialize()
+{
+	_rendererName = (const char*)glGetString(GL_RENDERER);
+
+	_rendererContext = std::make_shared<glrenderer::RendererContext>();
+	_scene = std::make_shared<glrenderer::Scene>(_rendererContext);
+	_camera = std::make_shared<glrenderer::Camera>();
+	_clusteredLighting = std::make_unique<ClusteredLighting>();
+
+	_rendererContext->SetEvents(_scene);
+	_scene->CreateDefaultScene();
+
+	if (_options.scenePath.empty())
+	{
+		createGeneratedScene();
+	}
+	else if (!_scene->ImportModel(_options.scenePath, 0))
+	{
+		std::cerr << "Bench: failed to import " << _options.scenePath << std::endl;
+		return false;
+	}
+
+	_cameraPath = CameraPath::Orbit(_options.frames);
+	if (!_options.cameraPathFile.empty() && !_cameraPath.Load(_options.cameraPathFile))
+		return false;
+
+	_clusteredLighting->Initialize();
+	_clusteredLighting->SetEnabled(_options.clusteredLighting);
+
+	_rendererContext->Resize(_options.width, _options.height);
+	_camera->updateAspectRatio((float)_options.width / (float)_options.height);
+
+	_records.resize(_options.frames);
+
+	if (_options.bvhEntities > 0)
+		_bvh = std::make_unique<BvhComparison>();
+
+	GpuProfiler::Initialize();
+	GpuProfiler::SetEnabled(true);
+	Profiler::SetEnabled(true);
+	AllocationTracker::SetEnabled(true);
+
+	// Warmup frames are measured but not recorded
+	GpuProfiler::SetResolveCallback([this](const GpuFrame& frame) {
+		if (frame.index < _options.warmupFrames || frame.index - _options.warmupFrames >= _records.size())
+			return;
+
+		FrameRecord& record = _records[frame.index - _options.warmupFrames];
+		record.gpu = frame;
+		record.hasGpu = true;
+	});
+
+	return true;
+}
+
+void Benchmark::createGeneratedScene()
+{
+	// Deterministic grid of cubes with lights floating above them
+	const uint32_t side = (uint32_t)std::ceil(std::sqrt((float)std::max(_options.generatedCubes, 1u)));
+	const float spacing = 3.0f;
+	const float offset = (side - 1) * spacing * 0.5f;
+
+	for (uint32_t i = 0; i < _options.generatedCubes; ++i)
+	{
+		glrenderer::Entity cube = _scene->CreateBaseEntity(glrenderer::EBaseEntityType::Cube);
+		cube.getComponent<glrenderer::TransformComponent>().location =
+			glm::vec3((i % side) * spacing - offset, 0.0f, (i / side) * spacing - offset);
+	}
+
+	const uint32_t lightSide = (uint32_t)std::ceil(std::sqrt((float)std::max(_options.generatedLights, 1u)));
+	const float lightSpacing = side * spacing / lightSide;
+	std::vector<std::shared_ptr<glrenderer::PointLight>> lights;
+	for (uint32_t i = 0; i < _options.generatedLights; ++i)
+	{
+		const glm::vec3 location((i % lightSide + 0.5f) * lightSpacing - offset - spacing * 0.5f, 2.0f,
+			(i / lightSide + 0.5f) * lightSpacing - offset - spacing * 0.5f);
+
+		glrenderer::Entity entity = _scene->CreateBaseEntity(glrenderer::EBaseEntityType::PointLight);
+		entity.getComponent<glrenderer::TransformComponent>().location = location;
+
+		auto light = std::dynamic_pointer_cast<glrenderer::PointLight>(entity.getComponent<glrenderer::LightComponent>().light);
+		if (light)
+		{
+			light->UpdateLocation(location);
+			lights.push_back(light);
+		}
+	}
+	_scene->UpdateLights(lights);
+}
+
+void Benchmark::Run()
+{
+	const uint32_t totalFrames = _options.warmupFrames + _options.frames;
+	for (uint32_t frame = 0; frame < totalFrames; ++frame)
+	{
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		ORYON_PROFILE_BEGIN_FRAME();
+		GpuProfiler::BeginFrame();
+
+		{
+			ORYON_PROFILE_SCOPE("CameraPath::Apply");
+			_cameraPath.Apply(frame, *_camera);
+		}
+
+		{
+			ORYON_PROFILE_SCOPE("RendererContext::RenderScene");
+			ORYON_GPU_SCOPE("RendererContext::RenderScene");
+			_clusteredLighting->Update(_scene->GetScene(), *_camera);
+			_rendererContext->RenderScene(_camera, _scene->GetScene(), glrenderer::Entity());
+		}
+
+		GpuProfiler::EndFrame();
+		ORYON_PROFILE_END_FRAME();
+		AllocationTracker::EndFrame();
+
+		// No swap buffers to push the commands to the GPU
+		glFlush();
+
+		if (frame < _options.warmupFrames)
+			continue;
+
+		FrameRecord& record = _records[frame - _options.warmupFrames];
+		record.cpuMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+		record.allocations = AllocationTracker::GetFrame(0).allocations;
+		record.allocatedBytes = AllocationTracker::GetFrame(0).bytes;
+
+		const ProfileFrame& profile = Profiler::GetFrame(0);
+		for (uint32_t i = 0; i < profile.scopeCount; ++i)
+		{
+			if (strcmp(profile.scopes[i].name, "RendererContext::RenderScene") == 0)
+				record.renderSceneMs = (profile.scopes[i].end - profile.scopes[i].start) / 1000.0f;
+		}
+	}
+
+	GpuProfiler::Flush();
+
+	// Separate pass, not part of the recorded frames
+	if (_bvh)
+		_bvh->Run(_options.bvhEntities);
+}
+
+FrameStats::Summary Benchmark::cpuSummary() const
+{
+	std::vector<float> samples;
+	for (const FrameRecord& record : _records)
+		samples.push_back(record.cpuMs);
+	return FrameStats::Summarize(samples.data(), (uint32_t)samples.size(), _options.hitchThresholdMs);
+}
+
+FrameStats::Summary Benchmark::gpuSummary() const
+{
+	std::vector<float> samples;
+	for (const FrameRecord& record : _records)
+	{
+		if (record.hasGpu)
+			samples.push_back(record.gpu.totalMs);
+	}
+	return FrameStats::Summarize(samples.data(), (uint32_t)samples.size(), _options.hitchThresholdMs);
+}
+
+bool Benchmark::WriteResults() const
+{
+	std::ofstream out(_options.outputPath);
+	if (!out)
+	{
+		std::cerr << "Bench: failed to open " << _options.outputPath << std::endl;
+		return false;
+	}
+
+	const std::string& path = _options.outputPath;
+	const bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+	if (json)
+		writeJson(out);
+	else
+		writeCsv(out);
+
+	return true;
+}
+
+void Benchmark::writeCsv(std::ostream& out) const
+{
+	// GPU pass columns come from the first resolved frame
+	const GpuFrame* passLayout = nullptr;
+	for (const FrameRecord& record : _records)
+	{
+		if (record.hasGpu)
+		{
+			passLayout = &record.gpu;
+			break;
+		}
+	}
+
+	out << "frame,cpu_ms,render_scene_cpu_ms,allocations,allocated_bytes,gpu_ms";
+	for (uint32_t i = 0; passLayout && i < passLayout->passCount; ++i)
+		out << ",gpu:" << passLayout->passes[i].name;
+	out << ",vertices,primitives,fragment_invocations\n";
+
+	for (size_t frame = 0; frame < _records.size(); ++frame)
+	{
+		const FrameRecord& record = _records[frame];
+		out << frame << "," << record.cpuMs << "," << record.renderSceneMs << ","
+			<< record.allocations << "," << record.allocatedBytes << ",";
+		if (record.hasGpu)
+			out << record.gpu.totalMs;
+
+		for (uint32_t i = 0; passLayout && i < passLayout->passCount; ++i)
+		{
+			out << ",";
+			if (record.hasGpu && i < record.gpu.passCount)
+				out << record.gpu.passes[i].ms;
+		}
+
+		if (record.hasGpu)
+			out << "," << record.gpu.verticesSubmitted << "," << record.gpu.primitivesSubmitted << "," << record.gpu.fragmentInvocations << "\n";
+		else
+			out << ",,,\n";
+	}
+}
+
+void Benchmark::writeJson(std::ostream& out) const
+{
+	out << "{\"renderer\":\"" << _rendererName << "\""
+		<< ",\"width\":" << _options.width
+		<< ",\"height\":" << _options.height
+		<< ",\"warmup_frames\":" << _options.warmupFrames
+		<< ",\"scene\":\"" << (_options.scenePath.empty() ? "generated" : _options.scenePath) << "\""
+		<< ",\"clustered_lighting\":" << (_clusteredLighting->IsAvailable() && _clusteredLighting->IsEnabled() ? "true" : "false")
+		<< ",\"pipeline_statistics\":" << (GpuProfiler::HasPipelineStatistics() ? "true" : "false");
+
+	out << ",\n\"cpu\":";
+	FrameStats::WriteJson(cpuSummary(), out);
+	out << ",\n\"gpu\":";
+	FrameStats::WriteJson(gpuSummary(), out);
+	if (_bvh)
+	{
+		out << ",\n\"bvh\":";
+		_bvh->WriteJson(out);
+	}
+
+	out << ",\n\"frames\":[";
+	for (size_t frame = 0; frame < _records.size(); ++frame)
+	{
+		const FrameRecord& record = _records[frame];
+		out << (frame == 0 ? "\n" : ",\n")
+			<< "{\"frame\":" << frame
+			<< ",\"cpu_ms\":" << record.cpuMs
+			<< ",\"render_scene_cpu_ms\":" << record.renderSceneMs
+			<< ",\"allocations\":" << record.allocations
+			<< ",\"allocated_bytes\":" << record.allocatedBytes;
+
+		if (record.hasGpu)
+		{
+			out << ",\"gpu_ms\":" << record.gpu.totalMs << ",\"gpu_passes\":{";
+			for (uint32_t i = 0; i < record.gpu.passCount; ++i)
+				out << (i == 0 ? "" : ",") << "\"" << record.gpu.passes[i].name << "\":" << record.gpu.passes[i].ms;
+			out << "},\"vertices\":" << record.gpu.verticesSubmitted
+				<< ",\"primitives\":" << record.gpu.primitivesSubmitted
+				<< ",\"fragment_invocations\":" << record.gpu.fragmentInvocations;
+		}
+		out << "}";
+	}
+	out << "\n]}\n";
+}
+
+void Benchmark::PrintSummary(std::ostream& out) const
+{
+	const FrameStats::Summary cpu = cpuSummary();
+	const FrameStats::Summary gpu = gpuSummary();
+
+	out << "Renderer: " << _rendererName << "\n";
+	out << "Frames:   " << cpu.totalFrames << " (" << _options.width << "x" << _options.height << ")\n";
+	out << "CPU ms:   avg " << cpu.averageMs << " | p50 " << cpu.p50Ms << " | p95 " << cpu.p95Ms << " | p99 " << cpu.p99Ms << " | max " << cpu.maxMs << "\n";
+	out << "GPU ms:   avg " << gpu.averageMs << " | p50 " << gpu.p50Ms << " | p95 " << gpu.p95Ms << " | p99 " << gpu.p99Ms << " | max " << gpu.maxMs << "\n";
+	uint64_t allocations = 0;
+	for (const FrameRecord& record : _records)
+		allocations += record.allocations;
+	out << "Allocs:   " << (_records.empty() ? 0.0 : (double)allocations / _records.size()) << " per frame\n";
+	out << "Hitches:  " << cpu.hitches << " above " << cpu.hitchThresholdMs << " ms" << std::endl;
+
+	if (_bvh && _bvh->GetReport().available)
+	{
+		const BvhReport& report = _bvh->GetReport();
+		out << "BVH:      " << report.entities << " entities | build " << report.buildMs << " ms, height " << report.height
+			<< " | update " << report.updateMs << " ms per frame, " << report.refits << " refits, " << report.reinserts << " reinserts, "
+			<< report.rebuiltLeaves << " leaves rebuilt | height " << report.finalHeight << " after " << report.frames << " frames" << std::endl;
+		const char* names[] = { "Frustum", "Sphere", "Box", "Ray" };
+		const BvhQueryReport* queries[] = { &report.frustum, &report.sphere, &report.box, &report.ray };
+		for (int i = 0; i < 4; ++i)
+		{
+			out << "  " << names[i] << ": " << queries[i]->bvhMs << " ms against " << queries[i]->linearMs << " ms linear | "
+				<< queries[i]->results << " results | " << queries[i]->mismatches << " mismatches" << std::endl;
+		}
+	}
+}
+
+void Benchmark::Free()
+{
+	GpuProfiler::SetResolveCallback(nullptr);
+	GpuProfiler::Free();
+
+	if (_clusteredLighting)
+		_clusteredLighting->Free();
+	if (_rendererContext)
+		_rendererContext->Free();
+}
+
+}
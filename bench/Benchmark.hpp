@@ -0,0 +1,104 @@
+#pragma once
+
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "CameraPath.hpp"
+#include "Profiling/FrameStats.hpp"
+#include "Profiling/GpuProfiler.hpp"
+#include "Rendering/ClusteredLighting.hpp"
+#include "BvhComparison.hpp"
+
+namespace glrenderer
+{
+	class RendererContext;
+	class Scene;
+	class Camera;
+}
+
+namespace oryon
+{
+
+struct BenchOptions
+{
+	uint32_t width = 1280;
+	uint32_t height = 720;
+	uint32_t frames = 500;
+	uint32_t warmupFrames = 50;
+
+	// glTF file, a generated scene is used if empty
+	std::string scenePath = "";
+	uint32_t generatedCubes = 1000;
+	uint32_t generatedLights = 64;
+
+	bool clusteredLighting = true;
+
+	// Entities of the BVH microbenchmark, skipped if 0
+	uint32_t bvhEntities = 0;
+
+	// Orbit around the scene if empty
+	std::string cameraPathFile = "";
+
+	// .json or .csv
+	std::string outputPath = "bench.csv";
+
+	float hitchThresholdMs = 33.3f;
+};
+
+/*
+* Renders a scene along a scripted camera path for a fixed number of frames
+* and records the CPU / GPU timings of every frame. Needs a current OpenGL context.
+*/
+class Benchmark
+{
+public:
+	Benchmark(const BenchOptions& options);
+
+	bool Initialize();
+
+	void Run();
+
+	bool WriteResults() const;
+
+	void PrintSummary(std::ostream& out) const;
+
+	void Free();
+
+private:
+	void createGeneratedScene();
+
+	FrameStats::Summary cpuSummary() const;
+	FrameStats::Summary gpuSummary() const;
+
+	void writeCsv(std::ostream& out) const;
+	void writeJson(std::ostream& out) const;
+
+private:
+	struct FrameRecord
+	{
+		float cpuMs = 0.0f;
+		float renderSceneMs = 0.0f;
+		uint64_t allocations = 0;
+		uint64_t allocatedBytes = 0;
+		bool hasGpu = false;
+		GpuFrame gpu;
+	};
+
+	BenchOptions _options;
+
+	std::shared_ptr<glrenderer::RendererContext> _rendererContext = nullptr;
+	std::shared_ptr<glrenderer::Scene> _scene = nullptr;
+	std::shared_ptr<glrenderer::Camera> _camera = nullptr;
+	std::unique_ptr<ClusteredLighting> _clusteredLighting = nullptr;
+	std::unique_ptr<BvhComparison> _bvh = nullptr;
+
+	CameraPath _cameraPath;
+
+	std::vector<FrameRecord> _records = {};
+
+	std::string _rendererName = "";
+};
+
+}
@@ -0,0 +1,259 @@
+#include "BvhComparison.hpp"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace oryon
+{
+
+namespace
+{
+	// Average spacing between the box centers
+	constexpr float SPACING = 4.0f;
+
+	constexpr float MOVE_STEP = 0.5f;
+
+	float elapsedMs(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+void BvhComparison::Run(uint32_t entities)
+{
+	_report = BvhReport();
+	_report.entities = entities;
+	if (entities == 0)
+		return;
+
+	_registry.clear();
+	_entities.resize(entities);
+	_registry.create(_entities.begin(), _entities.end());
+	_bvh.Clear();
+	_bounds.Clear();
+	_random.seed(entities);
+	_worldExtent = 0.5f * SPACING * std::cbrt((float)entities);
+
+	std::uniform_real_distribution<float> position(-_worldExtent, _worldExtent);
+	std::uniform_real_distribution<float> size(0.25f, 1.5f);
+	for (uint32_t i = 0; i < entities; ++i)
+		_bounds.Push(glm::vec3(position(_random), position(_random), position(_random)), glm::vec3(size(_random), size(_random), size(_random)));
+
+	auto start = std::chrono::steady_clock::now();
+	for (uint32_t i = 0; i < entities; ++i)
+		_bvh.Set(_entities[i], _bounds.GetCenter(i), _bounds.GetExtent(i));
+	_bvh.Commit();
+	_report.buildMs = elapsedMs(start);
+	_report.nodes = _bvh.GetNodeCount();
+	_report.height = _bvh.GetHeight();
+
+	std::uniform_int_distribution<uint32_t> pick(0, entities - 1);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	const uint32_t moved = std::max(1u, (uint32_t)(entities * MOVED_RATIO));
+	const float queryRadius = 2.0f * SPACING;
+	const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, _worldExtent);
+	for (uint32_t frame = 0; frame < FRAMES; ++frame)
+	{
+		// The moves set the leaves, part of the update
+		start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < moved; ++i)
+			move(pick(_random));
+		_bvh.Commit();
+		_report.updateMs += elapsedMs(start);
+		_report.refits += _bvh.GetRefits();
+		_report.reinserts += _bvh.GetReinserts();
+		_report.rebuiltLeaves += _bvh.GetRebuiltLeaves();
+
+		// A camera inside the boxes, looking at the center
+		const glm::vec3 eye(position(_random), position(_random), position(_random));
+		queryFrustum(Frustum(projection * glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f))));
+
+		for (uint32_t query = 0; query < QUERIES; ++query)
+		{
+			const glm::vec3 center(position(_random), position(_random), position(_random));
+			querySphere(center, queryRadius);
+			queryBox(center, glm::vec3(queryRadius));
+
+			glm::vec3 direction(unit(_random), unit(_random), unit(_random));
+			if (glm::dot(direction, direction) < 1e-4f)
+				direction = glm::vec3(1.0f, 0.0f, 0.0f);
+			queryRay(center, glm::normalize(direction), 2.0f * _worldExtent);
+		}
+	}
+
+	_report.frames = FRAMES;
+	_report.updateMs /= FRAMES;
+	_report.refits /= FRAMES;
+	_report.reinserts /= FRAMES;
+	_report.rebuiltLeaves /= FRAMES;
+	_report.finalHeight = _bvh.GetHeight();
+	for (BvhQueryReport* report : { &_report.frustum, &_report.sphere, &_report.box, &_report.ray })
+	{
+		report->bvhMs /= FRAMES;
+		report->linearMs /= FRAMES;
+		report->results /= FRAMES;
+	}
+	_report.available = true;
+}
+
+void BvhComparison::move(uint32_t index)
+{
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+	glm::vec3 center = _bounds.GetCenter(index);
+	const glm::vec3 target(unit(_random), unit(_random), unit(_random));
+	if (chance(_random) < TELEPORT_RATIO)
+		center = target * _worldExtent;
+	else
+		center = glm::clamp(center + target * MOVE_STEP, glm::vec3(-_worldExtent), glm::vec3(_worldExtent));
+
+	_bounds.centerX[index] = center.x;
+	_bounds.centerY[index] = center.y;
+	_bounds.centerZ[index] = center.z;
+	_bvh.Set(_entities[index], center, _bounds.GetExtent(index));
+}
+
+void BvhComparison::queryFrustum(const Frustum& frustum)
+{
+	_bvhResult.clear();
+	auto start = std::chrono::steady_clock::now();
+	_bvh.QueryFrustum(frustum, _bvhResult);
+	_report.frustum.bvhMs += elapsedMs(start);
+
+	start = std::chrono::steady_clock::now();
+	frustum.Cull(_bounds, _indices);
+	_report.frustum.linearMs += elapsedMs(start);
+
+	_linearResult.clear();
+	for (uint32_t index : _indices)
+		_linearResult.push_back(_entities[index]);
+	compare(_report.frustum);
+}
+
+void BvhComparison::querySphere(const glm::vec3& center, float radius)
+{
+	_bvhResult.clear();
+	auto start = std::chrono::steady_clock::now();
+	_bvh.QuerySphere(center, radius, _bvhResult);
+	_report.sphere.bvhMs += elapsedMs(start);
+
+	_linearResult.clear();
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < _bounds.Size(); ++i)
+	{
+		const glm::vec3 boxCenter = _bounds.GetCenter(i);
+		const glm::vec3 boxExtent = _bounds.GetExtent(i);
+		const glm::vec3 offset = glm::clamp(center, boxCenter - boxExtent, boxCenter + boxExtent) - center;
+		if (glm::dot(offset, offset) <= radius * radius)
+			_linearResult.push_back(_entities[i]);
+	}
+	_report.sphere.linearMs += elapsedMs(start);
+	compare(_report.sphere);
+}
+
+void BvhComparison::queryBox(const glm::vec3& center, const glm::vec3& extent)
+{
+	_bvhResult.clear();
+	auto start = std::chrono::steady_clock::now();
+	_bvh.QueryBox(center, extent, _bvhResult);
+	_report.box.bvhMs += elapsedMs(start);
+
+	const glm::vec3 min = center - extent;
+	const glm::vec3 max = center + extent;
+	_linearResult.clear();
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < _bounds.Size(); ++i)
+	{
+		const glm::vec3 boxCenter = _bounds.GetCenter(i);
+		const glm::vec3 boxExtent = _bounds.GetExtent(i);
+		if (glm::all(glm::lessThanEqual(boxCenter - boxExtent, max)) && glm::all(glm::greaterThanEqual(boxCenter + boxExtent, min)))
+			_linearResult.push_back(_entities[i]);
+	}
+	_report.box.linearMs += elapsedMs(start);
+	compare(_report.box);
+}
+
+void BvhComparison::queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance)
+{
+	entt::entity hit = entt::null;
+	float hitDistance = 0.0f;
+	auto start = std::chrono::steady_clock::now();
+	const bool found = _bvh.Raycast(origin, direction, maxDistance, hit, hitDistance);
+	_report.ray.bvhMs += elapsedMs(start);
+
+	// Closest entry over every box
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	float closest = maxDistance;
+	bool linearFound = false;
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < _bounds.Size(); ++i)
+	{
+		const glm::vec3 center = _bounds.GetCenter(i);
+		const glm::vec3 extent = _bounds.GetExtent(i);
+		float distance;
+		if (SceneBvh::RayBox(center - extent, center + extent, origin, inverseDirection, closest, distance))
+		{
+			closest = distance;
+			linearFound = true;
+		}
+	}
+	_report.ray.linearMs += elapsedMs(start);
+
+	// Distances only: boxes entered at the same distance can hit either
+	_report.ray.results += found ? 1.0f : 0.0f;
+	if (found != linearFound || (found && std::abs(hitDistance - closest) > 1e-4f * std::max(1.0f, closest)))
+		++_report.ray.mismatches;
+}
+
+void BvhComparison::compare(BvhQueryReport& report)
+{
+	report.results += (float)_bvhResult.size();
+	if (_bvhResult.size() != _linearResult.size())
+	{
+		++report.mismatches;
+		return;
+	}
+
+	std::sort(_bvhResult.begin(), _bvhResult.end());
+	std::sort(_linearResult.begin(), _linearResult.end());
+	if (_bvhResult != _linearResult)
+		++report.mismatches;
+}
+
+void BvhComparison::WriteJson(std::ostream& out) const
+{
+	out << "{\"available\":" << (_report.available ? "true" : "false")
+		<< ",\"entities\":" << _report.entities
+		<< ",\"frames\":" << _report.frames
+		<< ",\"build_ms\":" << _report.buildMs
+		<< ",\"nodes\":" << _report.nodes
+		<< ",\"height\":" << _report.height
+		<< ",\"update_ms\":" << _report.updateMs
+		<< ",\"refits\":" << _report.refits
+		<< ",\"reinserts\":" << _report.reinserts
+		<< ",\"rebuilt_leaves\":" << _report.rebuiltLeaves
+		<< ",\"final_height\":" << _report.finalHeight
+		<< ",\"frustum\":";
+	writeJson(_report.frustum, out);
+	out << ",\"sphere\":";
+	writeJson(_report.sphere, out);
+	out << ",\"box\":";
+	writeJson(_report.box, out);
+	out << ",\"ray\":";
+	writeJson(_report.ray, out);
+	out << "}";
+}
+
+void BvhComparison::writeJson(const BvhQueryReport& report, std::ostream& out)
+{
+	out << "{\"bvh_ms\":" << report.bvhMs
+		<< ",\"linear_ms\":" << report.linearMs
+		<< ",\"results\":" << report.results
+		<< ",\"mismatches\":" << report.mismatches << "}";
+}
+
+}
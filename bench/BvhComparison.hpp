@@ -0,0 +1,95 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "Rendering/Frustum.hpp"
+#include "Rendering/SceneBvh.hpp"
+
+namespace oryon
+{
+
+// One query type, averages per frame over the same queries
+struct BvhQueryReport
+{
+	float bvhMs = 0.0f;
+	float linearMs = 0.0f;
+	float results = 0.0f;
+	uint32_t mismatches = 0;
+};
+
+struct BvhReport
+{
+	bool available = false;
+	uint32_t entities = 0;
+	uint32_t frames = 0;
+
+	// Set() of every entity and the first Commit()
+	float buildMs = 0.0f;
+	uint32_t nodes = 0;
+	uint32_t height = 0;
+
+	// Per frame: Set() of the moved entities and Commit()
+	float updateMs = 0.0f;
+	float refits = 0.0f;
+	float reinserts = 0.0f;
+	float rebuiltLeaves = 0.0f;
+	uint32_t finalHeight = 0;
+
+	BvhQueryReport frustum;
+	BvhQueryReport sphere;
+	BvhQueryReport box;
+	BvhQueryReport ray;
+};
+
+/*
+* SceneBvh against linear scans over the same boxes, no OpenGL
+* Random boxes in a cube growing with their count, MOVED_RATIO of them moved every frame: most by
+* a step, the rest teleported. The frustum scan is the SIMD kernel of Frustum, the other scans
+* are plain loops. Every query result is checked against its scan.
+*/
+class BvhComparison
+{
+public:
+	static constexpr uint32_t FRAMES = 60;
+	static constexpr float MOVED_RATIO = 0.01f;
+	static constexpr float TELEPORT_RATIO = 0.1f;
+	static constexpr uint32_t QUERIES = 16;		// spheres, boxes and rays per frame
+
+	void Run(uint32_t entities);
+
+	const BvhReport& GetReport() const { return _report; }
+
+	void WriteJson(std::ostream& out) const;
+
+private:
+	void move(uint32_t index);
+	void queryFrustum(const Frustum& frustum);
+	void querySphere(const glm::vec3& center, float radius);
+	void queryBox(const glm::vec3& center, const glm::vec3& extent);
+	void queryRay(const glm::vec3& origin, const glm::vec3& direction, float maxDistance);
+	void compare(BvhQueryReport& report);
+	static void writeJson(const BvhQueryReport& report, std::ostream& out);
+
+private:
+	entt::registry _registry;
+	std::vector<entt::entity> _entities = {};
+	BoundsArrays _bounds;
+	SceneBvh _bvh;
+
+	std::mt19937 _random;
+	float _worldExtent = 0.0f;
+
+	std::vector<entt::entity> _bvhResult = {};
+	std::vector<entt::entity> _linearResult = {};
+	std::vector<uint32_t> _indices = {};
+
+	BvhReport _report;
+};
+
+}
@@ -0,0 +1,82 @@
+#include "CameraPath.hpp"
+
+#include "GLRenderer/Camera.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+namespace oryon
+{
+
+CameraPath CameraPath::Orbit(uint32_t frames)
+{
+	// Rotation deltas are in pixels of mouse drag, 1000 px is roughly a full turn
+	CameraPath path;
+	Segment segment;
+	segment.frames = frames > 0 ? frames : 1;
+	segment.rotate = { 1000.0f / segment.frames, 0.0f };
+	path._segments.push_back(segment);
+	path._length = segment.frames;
+	return path;
+}
+
+bool CameraPath::Load(const std::string& path)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		std::cerr << "CameraPath: failed to open " << path << std::endl;
+		return false;
+	}
+
+	_segments.clear();
+	_length = 0;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		line = line.substr(0, line.find('#'));
+
+		std::istringstream stream(line);
+		Segment segment;
+		if (!(stream >> segment.frames))
+			continue;
+		stream >> segment.rotate.x >> segment.rotate.y >> segment.zoom >> segment.pan.x >> segment.pan.y;
+
+		if (segment.frames == 0)
+			continue;
+		_segments.push_back(segment);
+		_length += segment.frames;
+	}
+
+	return _length > 0;
+}
+
+void CameraPath::Apply(uint32_t frame, glrenderer::Camera& camera) const
+{
+	if (_length == 0)
+		return;
+
+	frame %= _length;
+	for (const Segment& segment : _segments)
+	{
+		if (frame >= segment.frames)
+		{
+			frame -= segment.frames;
+			continue;
+		}
+
+		if (segment.rotate != glm::vec2(0.0f))
+			camera.rotate(segment.rotate);
+		if (segment.zoom != 0.0f)
+			camera.zoom(segment.zoom);
+		if (segment.pan != glm::vec2(0.0f))
+			camera.pan(segment.pan);
+		break;
+	}
+
+	camera.updateVectors();
+}
+
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace glrenderer { class Camera; }
+
+namespace oryon
+{
+
+/*
+* Scripted camera movement, expressed with the same deltas as the CameraController
+* File format, one segment per line ('#' starts a comment):
+*   frames rotateX rotateY zoom panX panY
+*/
+class CameraPath
+{
+public:
+	struct Segment
+	{
+		uint32_t frames = 1;
+		glm::vec2 rotate = { 0.0f, 0.0f };
+		float zoom = 0.0f;
+		glm::vec2 pan = { 0.0f, 0.0f };
+	};
+
+	// Full turn around the target over the given number of frames
+	static CameraPath Orbit(uint32_t frames);
+
+	bool Load(const std::string& path);
+
+	// Moves the camera by the step of the given frame, the path loops
+	void Apply(uint32_t frame, glrenderer::Camera& camera) const;
+
+	uint32_t GetLength() const { return _length; }
+
+private:
+	std::vector<Segment> _segments = {};
+	uint32_t _length = 0;
+};
+
+}
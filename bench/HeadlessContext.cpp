@@ -0,0 +1,106 @@
+#include "HeadlessContext.hpp"
+
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <iostream>
+
+namespace oryon
+{
+
+HeadlessContext::~HeadlessContext()
+{
+	Free();
+}
+
+int HeadlessContext::Init()
+{
+	/* Prefer the surfaceless platform, no display server needed */
+	auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay)
+		_display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	if (_display == EGL_NO_DISPLAY)
+		_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if (_display == EGL_NO_DISPLAY || !eglInitialize(_display, nullptr, nullptr))
+	{
+		std::cerr << "EGL: Failed to initialize display" << std::endl;
+		return 0;
+	}
+
+	if (!eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cerr << "EGL: OpenGL API not supported" << std::endl;
+		return 0;
+	}
+
+	const EGLint configAttributes[] = {
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+		EGL_DEPTH_SIZE, 24,
+		EGL_NONE
+	};
+	EGLConfig config = nullptr;
+	EGLint configCount = 0;
+	if (!eglChooseConfig(_display, configAttributes, &config, 1, &configCount) || configCount == 0)
+		config = nullptr; // EGL_KHR_no_config_context
+
+	/* Same profile as the editor window, core 3.3 as a fallback */
+	const EGLint compatibilityAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4, EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_COMPATIBILITY_PROFILE_BIT,
+		EGL_NONE
+	};
+	const EGLint coreAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	_context = eglCreateContext(_display, config, EGL_NO_CONTEXT, compatibilityAttributes);
+	if (_context == EGL_NO_CONTEXT)
+		_context = eglCreateContext(_display, config, EGL_NO_CONTEXT, coreAttributes);
+
+	if (_context == EGL_NO_CONTEXT)
+	{
+		std::cerr << "EGL: Failed to create context (0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+		return 0;
+	}
+
+	/* Everything is rendered into framebuffer objects, no surface needed */
+	if (!eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, _context))
+	{
+		std::cerr << "EGL: Failed to make the context current" << std::endl;
+		return 0;
+	}
+
+	/* Initialize glad: load all OpenGL function pointers */
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		return 0;
+	}
+
+	return 1;
+}
+
+void HeadlessContext::Free()
+{
+	if (_display == EGL_NO_DISPLAY)
+		return;
+
+	eglMakeCurrent(_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (_context != EGL_NO_CONTEXT)
+		eglDestroyContext(_display, _context);
+	eglTerminate(_display);
+
+	_context = EGL_NO_CONTEXT;
+	_display = EGL_NO_DISPLAY;
+}
+
+const char* HeadlessContext::GetRendererName() const
+{
+	return (const char*)glGetString(GL_RENDERER);
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace oryon
+{
+
+/*
+* OpenGL context without any window
+* Uses the Mesa surfaceless EGL platform when available (llvmpipe is enough), the default display otherwise.
+*/
+class HeadlessContext
+{
+public:
+	HeadlessContext() = default;
+	~HeadlessContext();
+
+	HeadlessContext(const HeadlessContext&) = delete;
+	HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+	int Init();
+
+	void Free();
+
+	const char* GetRendererName() const;
+
+private:
+	// EGLDisplay / EGLContext, egl.h stays out of the header (it pulls X11 on some platforms)
+	void* _display = nullptr;
+	void* _context = nullptr;
+};
+
+}
@@ -0,0 +1,85 @@
+#include "HeadlessContext.hpp"
+#include "Benchmark.hpp"
+
+#include <string.h>
+#include <stdlib.h>
+#include <iostream>
+
+/*
+* OryonBench: headless render benchmark
+*   --frames N         recorded frames (500)
+*   --warmup N         frames rendered before recording (50)
+*   --size WxH         render buffer size (1280x720)
+*   --scene file.gltf  glTF scene, a generated grid otherwise
+*   --cubes N          cubes of the generated scene (1000)
+*   --lights N         point lights of the generated scene (64)
+*   --no-clusters      shade every light for every pixel, no clustered light culling
+*   --bvh N            after the run, BVH updates and queries over N boxes against linear scans (0)
+*   --camera path.txt  camera path (see CameraPath), an orbit otherwise
+*   --hitch-ms X       hitch threshold (33.3)
+*   --output out.csv   per-frame timings, .csv or .json
+*/
+static bool parseArgs(int argc, char** argv, oryon::BenchOptions& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		const bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--frames") == 0 && hasValue)
+			options.frames = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--warmup") == 0 && hasValue)
+			options.warmupFrames = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--size") == 0 && hasValue)
+		{
+			const char* size = argv[++i];
+			options.width = (uint32_t)atoi(size);
+			const char* separator = strchr(size, 'x');
+			options.height = separator ? (uint32_t)atoi(separator + 1) : options.height;
+		}
+		else if (strcmp(argv[i], "--scene") == 0 && hasValue)
+			options.scenePath = argv[++i];
+		else if (strcmp(argv[i], "--cubes") == 0 && hasValue)
+			options.generatedCubes = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--lights") == 0 && hasValue)
+			options.generatedLights = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--no-clusters") == 0)
+			options.clusteredLighting = false;
+		else if (strcmp(argv[i], "--bvh") == 0 && hasValue)
+			options.bvhEntities = (uint32_t)atoi(argv[++i]);
+		else if (strcmp(argv[i], "--camera") == 0 && hasValue)
+			options.cameraPathFile = argv[++i];
+		else if (strcmp(argv[i], "--hitch-ms") == 0 && hasValue)
+			options.hitchThresholdMs = (float)atof(argv[++i]);
+		else if (strcmp(argv[i], "--output") == 0 && hasValue)
+			options.outputPath = argv[++i];
+		else
+		{
+			std::cerr << "Unknown argument: " << argv[i] << std::endl;
+			return false;
+		}
+	}
+
+	return options.frames > 0 && options.width > 0 && options.height > 0;
+}
+
+int main(int argc, char** argv)
+{
+	oryon::BenchOptions options;
+	if (!parseArgs(argc, argv, options))
+		return 1;
+
+	oryon::HeadlessContext context;
+	if (!context.Init())
+		return 1;
+
+	oryon::Benchmark benchmark(options);
+	if (!benchmark.Initialize())
+		return 1;
+
+	benchmark.Run();
+	benchmark.PrintSummary(std::cout);
+
+	const bool written = benchmark.WriteResults();
+	benchmark.Free();
+
+	return written ? 0 : 1;
+}
@@ -1,4 +1,4 @@
-#version 330 core
+#version 430 core
 out vec4 FragColor;
 
 in vec2 vTexCoords;
@@ -31,12 +31,48 @@ struct PointLight
 
     vec4 specular;
 };
-#define MAX_NUM_TOTAL_LIGHTS 1000
-layout (std140) uniform Lights
+// Point lights, filled by Oryon (Rendering/LightBuffer)
+struct GpuLight
 {
-    PointLight uPointLights[MAX_NUM_TOTAL_LIGHTS];
+    vec4 positionRadius;
+    vec4 colorIntensity;
+    vec4 attenuation;       // linear, quadratic
+};
+layout (std430, binding = 11) buffer LightBuffer
+{
+    uvec4 uLightCount;
+    GpuLight uLights[];
+};
+
+PointLight ToPointLight(GpuLight gpuLight)
+{
+    PointLight light;
+    light.position = gpuLight.positionRadius.xyz;
+    light.intensity = gpuLight.colorIntensity.w;
+    light.ambient = gpuLight.colorIntensity.rgb;
+    light.diffuse = gpuLight.colorIntensity.rgb;
+    light.specular = vec4(gpuLight.colorIntensity.rgb, 1.0);
+    light.linear = gpuLight.attenuation.x;
+    light.quadratic = gpuLight.attenuation.y;
+    return light;
+}
+
+// Clustered lighting, filled by Oryon (Rendering/ClusteredLighting)
+layout (std430, binding = 8) buffer ClusterHeader
+{
+    mat4 uClusterView;
+    uvec4 uClusterGrid;     // w: enabled
+    vec4 uClusterDepth;     // near, far, slice scale, slice bias
+    uvec4 uClusterFlags;    // x: heatmap
+};
+layout (std430, binding = 9) buffer Clusters
+{
+    uvec2 uClusters[];      // offset, count
+};
+layout (std430, binding = 10) buffer ClusterLightIndices
+{
+    uint uClusterLightIndices[];
 };
-uniform int uNumPointLights;
 
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
@@ -92,6 +128,20 @@ vec3 ComputeDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir,
     return vec3(ambient + (1.0 - shadow) * (diffuse + specular));
 }
 
+uint ComputeCluster(vec3 fragPos)
+{
+    float depth = -(uClusterView * vec4(fragPos, 1.0)).z;
+    uint slice = uint(clamp(log(depth) * uClusterDepth.z + uClusterDepth.w, 0.0, float(uClusterGrid.z - 1u)));
+    uvec2 tile = min(uvec2(vTexCoords * vec2(uClusterGrid.xy)), uClusterGrid.xy - 1u);
+    return (slice * uClusterGrid.y + tile.y) * uClusterGrid.x + tile.x;
+}
+
+vec3 Heatmap(uint count)
+{
+    float t = clamp(float(count) / 32.0, 0.0, 1.0);
+    return clamp(vec3(4.0 * t - 2.0, 2.0 - abs(4.0 * t - 2.0), 2.0 - 4.0 * t), 0.0, 1.0);
+}
+
 // Constants
 const float GAMMA = 2.2;
 const float INV_GAMMA = 1. / GAMMA;
@@ -114,12 +164,32 @@ void main()
     float shadow = 0.0;
     //vec3 fColor = ComputeDirectionalLight(directionalLight, Normal, ViewDir, shadow, Diffuse);
     vec3 fColor = vec3(0, 0, 0);
-    for (int i = 0; i < MAX_NUM_TOTAL_LIGHTS; i++)
+    if (uClusterGrid.w != 0u)
     {
-        if (i == uNumPointLights)
-            break;
-
-        fColor += ComputePointLight(uPointLights[i], Normal, FragPos, ViewDir, shadow, Diffuse);
+        // Only the lights whose radius reaches the cluster of the fragment
+        uvec2 cluster = uClusters[ComputeCluster(FragPos)];
+        for (uint i = cluster.x; i < cluster.x + cluster.y; i++)
+        {
+            GpuLight light = uLights[uClusterLightIndices[i]];
+            if (distance(light.positionRadius.xyz, FragPos) > light.positionRadius.w)
+                continue;
+
+            fColor += ComputePointLight(ToPointLight(light), Normal, FragPos, ViewDir, shadow, Diffuse);
+        }
+
+        if (uClusterFlags.x != 0u)
+            fColor = Heatmap(cluster.y);
+    }
+    else
+    {
+        for (uint i = 0u; i < uLightCount.x; i++)
+        {
+            // Same cutoff as the clustered path, a light does not reach past its radius
+            if (distance(uLights[i].positionRadius.xyz, FragPos) > uLights[i].positionRadius.w)
+                continue;
+
+            fColor += ComputePointLight(ToPointLight(uLights[i]), Normal, FragPos, ViewDir, shadow, Diffuse);
+        }
     }
 
     FragColor = vec4(LINEARtoSRGB(fColor.rgb), 1.0);
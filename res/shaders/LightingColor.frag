@@ -1,4 +1,4 @@
-﻿#version 330 core
+﻿#version 430 core
 
 out vec4 fFragColor;
 
@@ -30,12 +30,31 @@ struct DirectionalLight
     float nearPlane;
 };
 
-#define MAX_NUM_TOTAL_LIGHTS 200
-layout (std140) uniform Lights
+// Point lights, filled by Oryon (Rendering/LightBuffer)
+struct GpuLight
 {
-    PointLight uPointLights[MAX_NUM_TOTAL_LIGHTS];
+    vec4 positionRadius;
+    vec4 colorIntensity;
+    vec4 attenuation;       // linear, quadratic
 };
-uniform int uNumPointLights;
+layout (std430, binding = 11) buffer LightBuffer
+{
+    uvec4 uLightCount;
+    GpuLight uLights[];
+};
+
+PointLight ToPointLight(GpuLight gpuLight)
+{
+    PointLight light;
+    light.position = gpuLight.positionRadius.xyz;
+    light.intensity = gpuLight.colorIntensity.w;
+    light.ambient = gpuLight.colorIntensity.rgb;
+    light.diffuse = gpuLight.colorIntensity.rgb;
+    light.specular = vec4(gpuLight.colorIntensity.rgb, 1.0);
+    light.linear = gpuLight.attenuation.x;
+    light.quadratic = gpuLight.attenuation.y;
+    return light;
+}
 
 // Vertex Shader Inputs
 in vec3 vNormal;  
@@ -92,12 +111,13 @@ void main()
     //float shadow = ComputeShadow(vFragPosLightSpace, normal);
     float shadow = 0.0;
     //fColor += ComputeDirectionalLight(directionalLight, normal, viewDir, shadow);
-    for (int i = 0; i < MAX_NUM_TOTAL_LIGHTS; i++)
+    for (uint i = 0u; i < uLightCount.x; i++)
     {
-        if (i == uNumPointLights)
-            break;
+        // Same cutoff as the clustered lighting pass, a light does not reach past its radius
+        if (distance(uLights[i].positionRadius.xyz, vFragPos) > uLights[i].positionRadius.w)
+            continue;
 
-        fColor += ComputePointLight(uPointLights[i], normal, vFragPos, viewDir, shadow, uColor);
+        fColor += ComputePointLight(ToPointLight(uLights[i]), normal, vFragPos, viewDir, shadow, uColor);
     }
 
 
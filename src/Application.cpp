@@ -1,7 +1,13 @@
 ﻿#include "Application.hpp"
 #include "Events/Input.hpp"
+#include "Profiling/Profiler.hpp"
+#include "Profiling/GpuProfiler.hpp"
+#include "Profiling/TraceCapture.hpp"
+#include "Profiling/AllocationTracker.hpp"
 
 #include <GLFW/glfw3.h>
+#include <iostream>
+#include <chrono>
 
 #include "GLRenderer/Renderer/ForwardRenderer.hpp"
 #include "GLRenderer/Renderer/DeferredRenderer.hpp"
@@ -20,68 +26,161 @@ void Application::Run()
 	_rendererContext = std::make_shared<glrenderer::RendererContext>();
 	_scene = std::make_unique<glrenderer::Scene>(_rendererContext);
 	_camera = std::make_unique <glrenderer::Camera>();
+	_frameStats = std::make_shared<FrameStats>(_window->GetHitchThreshold());
+	_frameScheduler = std::make_shared<FrameScheduler>(_window->IsRenderOnDemand());
+	_clusteredLighting = std::make_shared<ClusteredLighting>();
 
 	_rendererContext->SetEvents(_scene);
 
 	_scene->CreateDefaultScene();
+	_clusteredLighting->Initialize();
 
 	Input::setWindow(_window->GetNativeWindow());
-	_editor->Initialize(_window->GetNativeWindow(), _rendererContext, _scene, _camera);
+	_editor->Initialize(_window->GetNativeWindow(), _rendererContext, _scene, _camera, _frameStats, _frameScheduler, _clusteredLighting);
 
 	CreateEditorPanels(_editor->GetPanels());
 
+	// Particle systems are not mirrored to the render thread
+	if (_window->UseRenderThread() && !_scene->GetParticuleSystems().empty())
+		std::cerr << "--render-thread is ignored, the scene has particle systems" << std::endl;
+	else if (_window->UseRenderThread())
+		startRenderThread();
+
+#ifdef ORYON_PROFILING
+	// Timer queries need the context, GPU timings are not available with the render thread
+	if (!_renderThread)
+		GpuProfiler::Initialize();
+
+	TraceCapture::SetThreadName("Main");
+	if (!_window->GetTracePath().empty() && TraceCapture::Start(_window->GetTracePath(), _window->GetTraceFrames()))
+	{
+		Profiler::SetEnabled(true);
+		GpuProfiler::SetEnabled(true);
+	}
+#else
+	if (!_window->GetTracePath().empty())
+		std::cerr << "--trace is not available, profiling is compiled out of this build" << std::endl;
+#endif
+
 	float deltaTime = 0.0f;	// Time between current frame and last frame
 	float lastFrame = 0.0f; // Time of last frame
-	long int frame = 0;
-	std::chrono::steady_clock::time_point begin;
-	std::chrono::steady_clock::time_point end;
 	while (!glfwWindowShouldClose(_window->GetNativeWindow()))
 	{
-		if (_editor->IsProfiling())
-		{
-			begin = std::chrono::high_resolution_clock::now();
-		}
+		// Idle time is not part of the frame
+		_frameScheduler->WaitForWork(*_window);
+		if (glfwWindowShouldClose(_window->GetNativeWindow()))
+			break;
+
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		ORYON_PROFILE_BEGIN_FRAME();
+		ORYON_GPU_BEGIN_FRAME();
 
 		float currentFrame = static_cast<float>(glfwGetTime());
 		deltaTime = currentFrame - lastFrame;
 		lastFrame = currentFrame;
 
 		_editor->OnUpdate(_scene);
-		
-		_rendererContext->RenderScene(_camera, _scene->GetScene(), _editor->GetEntitySelected());
 
-		_editor->Draw();
+		if (_renderThread)
+		{
+			submitFrame();
+		}
+		else
+		{
+			// Otherwise the viewport shows the render buffer of the last frame
+			if (_editor->ShouldRenderViewport())
+			{
+				ORYON_PROFILE_SCOPE("RendererContext::RenderScene");
+				ORYON_GPU_SCOPE("RendererContext::RenderScene");
+				_clusteredLighting->Update(_scene->GetScene(), *_camera);
+				_rendererContext->RenderScene(_camera, _scene->GetScene(), _editor->GetEntitySelected());
+			}
 
-		/* Swap front and back buffers */
-		glfwSwapBuffers(_window->GetNativeWindow());
-		
-		/* Poll for and process events */
-		glfwPollEvents();
+			_editor->Draw();
 
-		if (_editor->IsProfiling())
-		{
-			end = std::chrono::high_resolution_clock::now();
-			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - begin);
-			_elpasedTimes.push_back(elapsed);
+			ORYON_GPU_END_FRAME();
 
-			++frame;
-			if (frame % 100 == 0)
+			/* Swap front and back buffers */
 			{
-				float average = 0.0f;
-				for (const auto time : _elpasedTimes)
-					average += time.count();
-				
-				average /= _elpasedTimes.size();
-				_editor->SetAverageTime(average);
-				_elpasedTimes.clear();
+				ORYON_PROFILE_SCOPE("glfwSwapBuffers");
+				glfwSwapBuffers(_window->GetNativeWindow());
 			}
 		}
+		
+		/* Poll for and process events */
+		{
+			ORYON_PROFILE_SCOPE("glfwPollEvents");
+			glfwPollEvents();
+		}
+
+		ORYON_PROFILE_END_FRAME();
+		ORYON_ALLOC_END_FRAME();
+		ORYON_TRACE_END_FRAME();
+
+		_frameStats->AddFrame(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count());
+	}
+
+	if (!_window->GetStatsPath().empty() && !_frameStats->WriteJson(_window->GetStatsPath()))
+		std::cerr << "Failed to write frame statistics to " << _window->GetStatsPath() << std::endl;
+
+	// Gives the context back to this thread
+	if (_renderThread)
+	{
+		_renderThread->Stop();
+		_sceneMirror.reset();
 	}
 
+#ifdef ORYON_PROFILING
+	TraceCapture::Free();
+	GpuProfiler::Free();
+#endif
 	_editor->Free();
+	_clusteredLighting->Free();
 	_rendererContext->Free();
 }
 
+void Application::startRenderThread()
+{
+	// Created with the context still current here
+	_sceneMirror = std::make_unique<SceneMirror>(std::make_shared<glrenderer::Scene>(_rendererContext));
+	_renderCamera = std::make_shared<glrenderer::Camera>();
+
+	_renderThread = std::make_unique<RenderThread>();
+	_editor->SetSubmitOnRenderThread(true);
+	_editor->RC_Execute = [this](const std::function<void()>& command) { _renderThread->Execute(command); };
+
+	_renderThread->Start(_window->GetNativeWindow(), [this](FrameSnapshot& snapshot) { renderSnapshot(snapshot); });
+}
+
+void Application::submitFrame()
+{
+	// Waits here if the render thread is a frame behind
+	ORYON_PROFILE_SCOPE("RenderThread::Submit");
+
+	FrameSnapshot& snapshot = _renderThread->BeginSnapshot();
+	snapshot.Capture(_scene->GetScene(), *_camera, _editor->GetEntitySelected(), _editor->ShouldRenderViewport());
+	snapshot.CaptureDrawData(_editor->Render());
+	_renderThread->Submit();
+}
+
+void Application::renderSnapshot(FrameSnapshot& snapshot)
+{
+	// Render thread: the profiler is main thread only
+	_sceneMirror->Apply(snapshot);
+
+	if (snapshot.ShouldRenderScene())
+	{
+		*_renderCamera = snapshot.GetCamera();
+		_clusteredLighting->Update(_sceneMirror->GetScene().GetScene(), *_renderCamera);
+		_rendererContext->RenderScene(_renderCamera, _sceneMirror->GetScene().GetScene(), _sceneMirror->GetSelected());
+	}
+
+	_editor->Submit(snapshot.GetDrawData());
+
+	glfwSwapBuffers(_window->GetNativeWindow());
+}
+
 void Application::OnEvent(Event& e)
 {
 	_editor->OnEvent(e);
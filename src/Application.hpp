@@ -1,12 +1,15 @@
 ﻿#pragma once
 
 #include <memory>
-#include <chrono>
 
 #include "Window.hpp"
+#include "FrameScheduler.hpp"
 #include "Editor/Editor.hpp"
 
 #include "Events/Event.hpp"
+#include "Profiling/FrameStats.hpp"
+#include "Rendering/RenderThread.hpp"
+#include "Rendering/ClusteredLighting.hpp"
 
 #include "GLRenderer/Renderer/RendererContext.hpp"
 #include "GLRenderer/Scene/Scene.hpp"
@@ -28,6 +31,12 @@ public:
 
 	void CreateEditorPanels(std::vector<Panel>& panels);
 
+private:
+	// Render thread mode
+	void startRenderThread();
+	void submitFrame();
+	void renderSnapshot(FrameSnapshot& snapshot);
+
 private:
 	std::unique_ptr<Window> _window = nullptr;
 
@@ -39,9 +48,15 @@ private:
 
 	std::shared_ptr<glrenderer::Camera> _camera = nullptr;
 
-private:
-// Profiling
-	std::vector<std::chrono::milliseconds> _elpasedTimes = {};
+	std::shared_ptr<FrameStats> _frameStats = nullptr;
+
+	std::shared_ptr<FrameScheduler> _frameScheduler = nullptr;
+
+	std::shared_ptr<ClusteredLighting> _clusteredLighting = nullptr;
+
+	std::unique_ptr<RenderThread> _renderThread = nullptr;
+	std::unique_ptr<SceneMirror> _sceneMirror = nullptr;
+	std::shared_ptr<glrenderer::Camera> _renderCamera = nullptr;
 };
 
 }
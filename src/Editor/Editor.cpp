@@ -33,6 +33,16 @@
 #include "GLRenderer/Lighting/DirectionalLight.hpp"
 #include "GLRenderer/Properties/Render/ShadowsProperties.hpp"
 #include "Events/Input.hpp"
+#include "Profiling/Profiler.hpp"
+#include "Profiling/GpuProfiler.hpp"
+#include "Profiling/TraceCapture.hpp"
+#include "Profiling/FrameStats.hpp"
+#include "Profiling/AllocationTracker.hpp"
+#include "FrameScheduler.hpp"
+#include "Rendering/ClusteredLighting.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 using namespace glrenderer;
 
@@ -47,9 +57,16 @@ Editor::Editor()
 void Editor::Initialize(GLFWwindow* window,
     const std::shared_ptr<class glrenderer::RendererContext>& rendererContext,
     const std::shared_ptr<class glrenderer::Scene>& scene,
-    const std::shared_ptr<class glrenderer::Camera>& camera)
+    const std::shared_ptr<class glrenderer::Camera>& camera,
+    const std::shared_ptr<class FrameStats>& frameStats,
+    const std::shared_ptr<class FrameScheduler>& frameScheduler,
+    const std::shared_ptr<class ClusteredLighting>& clusteredLighting)
 {
     _scene = scene;
+    _frameStats = frameStats;
+    _frameScheduler = frameScheduler;
+    _clusteredLighting = clusteredLighting;
+    _worldOutliner.Connect(*scene);
 
     // Initialize ImGui
     IMGUI_CHECKVERSION();
@@ -76,28 +93,57 @@ void Editor::Initialize(GLFWwindow* window,
     _cameraController = std::make_shared<CameraController>(camera);
 
     // Assign Callback
-    // Scene
-    SC_ImportModel = std::bind<bool>(&glrenderer::Scene::ImportModel, scene, std::placeholders::_1, std::placeholders::_2);
-    SC_RenameEntity = std::bind<void>(&glrenderer::Scene::RenameEntity, scene, std::placeholders::_1, std::placeholders::_2);
-    SC_CreateEntity = std::bind<glrenderer::Entity>(&glrenderer::Scene::CreateBaseEntity, scene, std::placeholders::_1);
-    SC_UpdateLight = std::bind<void>(&glrenderer::Scene::UpdateLights, scene, std::placeholders::_1);
-    SC_Duplicate = std::bind<glrenderer::Entity>(&glrenderer::Scene::Duplicate, scene, std::placeholders::_1);
+    // Scene, edits visible in the viewport invalidate the last frame
+    // Scene edits may touch OpenGL (meshes, lights buffer), they run on the render thread if there is one
+    SC_ImportModel = [this, scene](const std::string& path, const uint32_t& groupId) {
+        _viewportCache.Invalidate();
+        bool imported = false;
+        RC_Execute([&] { imported = scene->ImportModel(path, groupId); });
+        return imported;
+    };
+    SC_RenameEntity = [this, scene](glrenderer::Entity& entity, const std::string& name) {
+        scene->RenameEntity(entity, name);
+        _worldOutliner.Refresh(entity);
+    };
+    SC_CreateEntity = [this, scene](glrenderer::EBaseEntityType type) {
+        _viewportCache.Invalidate();
+        glrenderer::Entity entity;
+        RC_Execute([&] { entity = scene->CreateBaseEntity(type); });
+        return entity;
+    };
+    SC_UpdateLight = [this, scene](const std::vector<std::shared_ptr<glrenderer::PointLight>>& lights) {
+        _viewportCache.Invalidate();
+        RC_Execute([&] { scene->UpdateLights(lights); });
+    };
+    SC_Duplicate = [this, scene](glrenderer::Entity entity) {
+        _viewportCache.Invalidate();
+        glrenderer::Entity duplicate;
+        RC_Execute([&] { duplicate = scene->Duplicate(entity); });
+        return duplicate;
+    };
 
 
     // RendererContext
-    RC_ResizeRenderBuffer = std::bind<void>(&glrenderer::RendererContext::Resize, rendererContext, std::placeholders::_1, std::placeholders::_2);
+    RC_ResizeRenderBuffer = [this, rendererContext](uint32_t width, uint32_t height) {
+        RC_Execute([&] { rendererContext->Resize(width, height); });
+    };
     _renderBufferTextureID = rendererContext->GetRenderBufferTextureID();
+
+    // Font texture and shaders, the next UI frames may be built without an OpenGL context
+    ImGui_ImplOpenGL3_NewFrame();
 }
 
 void Editor::OnUpdate(std::shared_ptr<glrenderer::Scene>& scene)
 {
+    ORYON_PROFILE_SCOPE("Editor::OnUpdate");
     if (_canDuplicate)
         _cameraController->onUpdate();
 
     //New ImGui Frame
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    ImGui_ImplOpenGL3_NewFrame();
+    if (!_submitOnRenderThread)
+        ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
     ImGuizmo::BeginFrame();
@@ -112,9 +158,13 @@ void Editor::OnUpdate(std::shared_ptr<glrenderer::Scene>& scene)
     setupDockspace();
 
     // Panels
-    for (auto& panel : _panels)
     {
-        panel.render();
+        ORYON_PROFILE_SCOPE("Panel::render");
+        for (auto& panel : _panels)
+        {
+            if (panel.render())
+                _viewportCache.Invalidate();
+        }
     }
 
     renderObjectPanel();
@@ -126,18 +176,47 @@ void Editor::OnUpdate(std::shared_ptr<glrenderer::Scene>& scene)
     renderMenuBar();
     renderPerformancePanel();
     renderParticuleSystemPanel(scene);
+
+    // Particles move every frame
+    if (!scene->GetParticuleSystems().empty())
+        _viewportCache.Invalidate();
+    _viewportCache.Update(*_cameraController->getCamera(), _entitySelected);
+
+    // Render on demand: keep drawing while something moves on screen
+    if (ImGui::IsAnyItemActive() || ImGuizmo::IsUsing() || !scene->GetParticuleSystems().empty()
+        || _profiling || TraceCapture::IsCapturing() || TraceCapture::IsWriting())
+        _frameScheduler->RequestContinuous();
   
     ImGui::End();
 }
 
 void Editor::Draw()
+{
+    ORYON_PROFILE_SCOPE("Editor::Draw");
+    ORYON_GPU_SCOPE("Editor::Draw");
+    Submit(Render());
+}
+
+ImDrawData* Editor::Render()
 {
     ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    return ImGui::GetDrawData();
+}
+
+void Editor::Submit(ImDrawData* drawData)
+{
+    if (!drawData)
+        return;
+
+    // Creates the device objects if needed
+    if (_submitOnRenderThread)
+        ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplOpenGL3_RenderDrawData(drawData);
 }
 
 void Editor::renderMenuBar()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderMenuBar");
     if (ImGui::BeginMenuBar())
     {
         if (ImGui::BeginMenu("File"))
@@ -151,6 +230,7 @@ void Editor::renderMenuBar()
 
                     if (result == NFD_OKAY) {
                         SC_ImportModel(std::string(outPath), _groupLabels.size() - 1);
+                        _frameScheduler->RequestRedraw();
                         free(outPath);
                     }
                     else {
@@ -163,6 +243,7 @@ void Editor::renderMenuBar()
                     static const std::string modelPath = "C:/dev/gltf-models/Sponza/Sponza.gltf";
                     _groupLabels.push_back("Sponza");
                     SC_ImportModel(modelPath, _groupLabels.size() - 1);
+                    _frameScheduler->RequestRedraw();
                 }
             
                 ImGui::EndMenu();
@@ -211,11 +292,18 @@ void Editor::renderMenuBar()
 
 void Editor::renderParticuleSystemPanel(std::shared_ptr<glrenderer::Scene>& scene)
 {
+    ORYON_PROFILE_SCOPE("Editor::renderParticuleSystemPanel");
     if (ImGui::Begin("Particule System"))
     {
-        if (ImGui::Button("Add"))
+        // The render thread draws a mirror of the scene, which has no particle systems
+        if (_submitOnRenderThread)
+        {
+            ImGui::TextDisabled("Particle systems are not drawn with --render-thread");
+        }
+        else if (ImGui::Button("Add"))
         {
-            scene->AddParticuleSystem();
+            RC_Execute([&] { scene->AddParticuleSystem(); });
+            _viewportCache.Invalidate();
         }
 
         if (_particuleSystemSelectedID >= 0)
@@ -223,7 +311,8 @@ void Editor::renderParticuleSystemPanel(std::shared_ptr<glrenderer::Scene>& scen
             ImGui::SameLine();
             if (ImGui::Button("Remove"))
             {
-                scene->RemoveParticuleSystemAtIndex(_particuleSystemSelectedID);
+                RC_Execute([&] { scene->RemoveParticuleSystemAtIndex(_particuleSystemSelectedID); });
+                _viewportCache.Invalidate();
                 _particuleSystemSelectedID = -1;
             }
         }
@@ -254,7 +343,8 @@ void Editor::renderParticuleSystemPanel(std::shared_ptr<glrenderer::Scene>& scen
         // Selected Particule System Panel
         if (_particuleSystemSelectedID >= 0)
         {
-            _particuleSystemPanel.render();
+            if (_particuleSystemPanel.render())
+                _viewportCache.Invalidate();
         }
         
     }
@@ -264,27 +354,23 @@ void Editor::renderParticuleSystemPanel(std::shared_ptr<glrenderer::Scene>& scen
 
 void Editor::renderWorldOutliner(std::shared_ptr<glrenderer::Scene>& scene)
 {
+    ORYON_PROFILE_SCOPE("Editor::renderWorldOutliner");
     if (ImGui::Begin("World Outliner"))
     {
-        scene->forEachEntity([this](glrenderer::Entity entity)
+        glrenderer::Entity clicked;
+        if (_worldOutliner.Render(_entitySelected, clicked))
         {
-            const auto& component = entity.getComponent<glrenderer::LabelComponent>();
-            const std::string& label = component.label;
-            //const uint32_t& groupId = component.groupId;
-
-            if (ImGui::Selectable((std::string(ICON_MDI_CUBE) + label).c_str(), _entitySelected == entity))
-            {
-                _entitySelected = entity;
-                onEntitySelectedChanged();
-            }
-
-        });
+            _entitySelected = clicked;
+            onEntitySelectedChanged();
+        }
     }
     ImGui::End(); // World Outliner
 }
 
 void Editor::renderObjectPanel()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderObjectPanel");
+
     if (!_entitySelected || !_entitySelected.hasComponent<glrenderer::TransformComponent>())
         return;
 
@@ -305,9 +391,11 @@ void Editor::renderObjectPanel()
             glm::vec3& rotation = _entitySelected.getComponent<glrenderer::TransformComponent>().rotation;
             glm::vec3& scale = _entitySelected.getComponent<glrenderer::TransformComponent>().scale;
 
-            ImGui::DragFloat3("Location", &location[0], 0.1f);
-            ImGui::DragFloat3("Rotation", &rotation[0], 0.1f);
-            ImGui::DragFloat3("Scale", &scale[0], 0.01f);
+            bool edited = ImGui::DragFloat3("Location", &location[0], 0.1f);
+            edited |= ImGui::DragFloat3("Rotation", &rotation[0], 0.1f);
+            edited |= ImGui::DragFloat3("Scale", &scale[0], 0.01f);
+            if (edited)
+                _viewportCache.Invalidate();
 
             ImGui::TreePop();
             ImGui::Separator();
@@ -318,6 +406,8 @@ void Editor::renderObjectPanel()
 
 void Editor::renderMaterialPanel()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderMaterialPanel");
+
     if (!_entitySelected || !_entitySelected.hasComponent<glrenderer::MeshComponent>())
         return;
 
@@ -331,13 +421,24 @@ void Editor::renderMaterialPanel()
         }
 
         auto& material = _entitySelected.getComponent<glrenderer::MeshComponent>().mesh->getMaterial();
-        if (ImGui::ColorEdit3("Color", &material->getDiffuse()[0]))
+        // Edited on a copy, the render thread may be reading the material
+        glm::vec3 diffuse = material->getDiffuse();
+        if (ImGui::ColorEdit3("Color", &diffuse[0]))
         {
-            material->updateDiffuse();
+            RC_Execute([&] {
+                material->getDiffuse() = diffuse;
+                material->updateDiffuse();
+            });
+            _viewportCache.Invalidate();
         }
-        if (ImGui::DragFloat("Roughness", &material->getRoughness(), 0.005f, 0.0f, 1.0f))
+        float roughness = material->getRoughness();
+        if (ImGui::DragFloat("Roughness", &roughness, 0.005f, 0.0f, 1.0f))
         {
-            material->updateRoughness();
+            RC_Execute([&] {
+                material->getRoughness() = roughness;
+                material->updateRoughness();
+            });
+            _viewportCache.Invalidate();
         }
         ImGui::Text("Shininess: %f", material->getShininess());
     }
@@ -347,21 +448,32 @@ void Editor::renderMaterialPanel()
 
 void Editor::renderLightPanel()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderLightPanel");
+
     if (!_pointLightSelected)
         return;
 
     if (ImGui::Begin("Light"))
     {
-        if (ImGui::ColorEdit3("Color", &_pointLightSelected->getColor()[0]))
+        // Edited on a copy, the render thread may be reading the light
+        glm::vec3 color = _pointLightSelected->getColor();
+        if (ImGui::ColorEdit3("Color", &color[0]))
         {
-            _pointLightSelected->UpdateDiffuse();
-            SC_UpdateLight({ _pointLightSelected });
+            RC_Execute([&] {
+                _pointLightSelected->getColor() = color;
+                _pointLightSelected->UpdateDiffuse();
+                SC_UpdateLight({ _pointLightSelected });
+            });
         }
 
-        if (ImGui::DragFloat("intensity", &_pointLightSelected->getIntensity(), 0.1f, 0.0f, 10.0f))
+        float intensity = _pointLightSelected->getIntensity();
+        if (ImGui::DragFloat("intensity", &intensity, 0.1f, 0.0f, 10.0f))
         {
-            _pointLightSelected->UpdateIntensity();
-            SC_UpdateLight({ _pointLightSelected });
+            RC_Execute([&] {
+                _pointLightSelected->getIntensity() = intensity;
+                _pointLightSelected->UpdateIntensity();
+                SC_UpdateLight({ _pointLightSelected });
+            });
         }
         
         glrenderer::PointLight* pointLight = _pointLightSelected->isPointLight();
@@ -370,8 +482,10 @@ void Editor::renderLightPanel()
             float radius = pointLight->getRadius();
             if (ImGui::DragFloat("radius", &radius, 0.1f, 7.0f, 600.0f))
             {
-                pointLight->setRadius(radius);
-                SC_UpdateLight({ _pointLightSelected });    
+                RC_Execute([&] {
+                    pointLight->setRadius(radius);
+                    SC_UpdateLight({ _pointLightSelected });
+                });
             }
             //ImGui::Text("Linear: %f", pointLight->getLinear());
             //ImGui::Text("Quadratic: %f", pointLight->getQuadratic());
@@ -436,6 +550,7 @@ void Editor::renderLightPanel()
 
 void Editor::renderViewer3DPanel()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderViewer3DPanel");
     if (ImGui::Begin("Viewer 3D"))
     {
         ImVec2 wsize = ImGui::GetContentRegionAvail();
@@ -445,6 +560,7 @@ void Editor::renderViewer3DPanel()
             _viewportHeight = wsize.y;
 
             RC_ResizeRenderBuffer(_viewportWidth, _viewportHeight);
+            _viewportCache.Invalidate();
 
             float ratio = _viewportWidth / _viewportHeight;
             auto& camera = _cameraController->getCamera();
@@ -477,6 +593,8 @@ void Editor::renderViewer3DPanel()
         
             if (ImGuizmo::IsUsing())
             {
+                _viewportCache.Invalidate();
+
                 if (_canDuplicate && Input::isKeyPressed(Key::LeftAlt) && _guizmoType == ImGuizmo::OPERATION::TRANSLATE)
                 {
                     _canDuplicate = false;
@@ -498,13 +616,15 @@ void Editor::renderViewer3DPanel()
 
                 if (_pointLightSelected)
                 {
-                    _pointLightSelected->UpdateLocation(translation);
-                    SC_UpdateLight({ _pointLightSelected });
+                    RC_Execute([&] {
+                        _pointLightSelected->UpdateLocation(translation);
+                        SC_UpdateLight({ _pointLightSelected });
+                    });
                 }
 
                 if (_entitySelected.hasComponent<glrenderer::CallbackComponent>())
                 {
-                    _entitySelected.getComponent<glrenderer::CallbackComponent>().OnTransformCallback();
+                    RC_Execute(_entitySelected.getComponent<glrenderer::CallbackComponent>().OnTransformCallback);
                 }
             }
 
@@ -516,21 +636,310 @@ void Editor::renderViewer3DPanel()
 
 void Editor::renderPerformancePanel()
 {
+    ORYON_PROFILE_SCOPE("Editor::renderPerformancePanel");
+
+    // A trace capture records even if the panel is hidden
+    const bool recording = (_profiling && !_profilerPaused) || TraceCapture::IsCapturing();
+    Profiler::SetEnabled(recording);
+    GpuProfiler::SetEnabled(recording);
+
     if (ImGui::Begin("Performance"))
     {
         ImGui::Text("FPS: %.1f", ImGui::GetIO().Framerate);
 
+        bool renderOnDemand = _frameScheduler->IsRenderOnDemand();
+        if (ImGui::Checkbox("Render on demand", &renderOnDemand))
+            _frameScheduler->SetRenderOnDemand(renderOnDemand);
+        if (renderOnDemand)
+        {
+            ImGui::SameLine();
+            ImGui::TextDisabled("idle %.0f%%", _frameScheduler->GetIdleRatio() * 100.0f);
+        }
+
+        renderFrameStats();
+
+        ImGui::Separator();
+        bool reuseViewport = _viewportCache.IsEnabled();
+        if (ImGui::Checkbox("Reuse viewport", &reuseViewport))
+            _viewportCache.SetEnabled(reuseViewport);
+        ImGui::SameLine();
+        ImGui::Text("hit rate %.1f%% (%llu / %llu)", _viewportCache.GetHitRate() * 100.0f,
+            (unsigned long long)_viewportCache.GetHits(), (unsigned long long)(_viewportCache.GetHits() + _viewportCache.GetMisses()));
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##ViewportCache"))
+            _viewportCache.ResetStats();
+
+        ImGui::Separator();
+        if (_clusteredLighting->IsAvailable())
+        {
+            const LightBuffer& lightBuffer = _clusteredLighting->GetLightBuffer();
+            ImGui::Text("Light buffer: %u / %u, uploaded %llu B in %u ranges", _clusteredLighting->GetLightCount(), lightBuffer.GetCapacity(),
+                (unsigned long long)lightBuffer.GetUploadedBytes(), lightBuffer.GetUploadedRanges());
+
+            bool clustered = _clusteredLighting->IsEnabled();
+            if (ImGui::Checkbox("Clustered lighting", &clustered))
+            {
+                _clusteredLighting->SetEnabled(clustered);
+                _viewportCache.Invalidate();
+            }
+            if (clustered)
+            {
+                ImGui::SameLine();
+                bool heatmap = _clusteredLighting->IsHeatmap();
+                if (ImGui::Checkbox("Heatmap", &heatmap))
+                {
+                    _clusteredLighting->SetHeatmap(heatmap);
+                    _viewportCache.Invalidate();
+                }
+                ImGui::Text("Lights: %u, %u indices, max %u / cluster, %.2f ms", _clusteredLighting->GetLightCount(),
+                    _clusteredLighting->GetIndexCount(), _clusteredLighting->GetMaxLightsPerCluster(), _clusteredLighting->GetBuildMs());
+            }
+
+        }
+        else
+        {
+            ImGui::TextDisabled("The light buffer needs OpenGL 4.3");
+        }
+
+        ImGui::Separator();
+        renderAllocations();
+
         ImGui::Separator();
         ImGui::Checkbox("Profile", &_profiling);
 
+#ifndef ORYON_PROFILING
         if (_profiling)
+            ImGui::TextDisabled("Profiling scopes are compiled out of this build");
+#endif
+
+        if (_profiling)
+        {
+            ImGui::SameLine();
+            ImGui::Checkbox("Pause", &_profilerPaused);
+        }
+
+#ifdef ORYON_PROFILING
+        // Chrome Trace Event capture
+        ImGui::InputText("Trace File", &_tracePath);
+        ImGui::InputInt("Frames", &_traceFrameCount);
+        _traceFrameCount = std::max(_traceFrameCount, 1);
+        if (TraceCapture::IsCapturing())
+        {
+            ImGui::Text("Capturing... %u frames left", TraceCapture::GetRemainingFrames());
+        }
+        else if (TraceCapture::IsWriting())
+        {
+            ImGui::Text("Writing %s...", TraceCapture::GetPath().c_str());
+        }
+        else if (ImGui::Button("Capture"))
         {
-            ImGui::Text("Time: %.1f ms", _averageTime);
+            TraceCapture::Start(_tracePath, (uint32_t)_traceFrameCount);
+        }
+        ImGui::Separator();
+#endif
+
+        const int frameCount = (int)Profiler::GetFrameCount();
+        if (_profiling && frameCount > 0)
+        {
+            // Frame times, oldest to newest
+            float frameTimes[Profiler::MAX_FRAMES];
+            float average = 0.0f;
+            for (int i = 0; i < frameCount; ++i)
+            {
+                frameTimes[i] = Profiler::GetFrame(frameCount - 1 - i).durationMs();
+                average += frameTimes[i];
+            }
+            average /= frameCount;
+
+            ImGui::Text("Time: %.3f ms (avg %.3f ms over %d frames)", frameTimes[frameCount - 1], average, frameCount);
+            ImGui::PlotHistogram("##FrameTimes", frameTimes, frameCount, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, 50.0f));
+
+            if (_profilerPaused)
+            {
+                ImGui::SliderInt("Frame Age", &_profilerFrameAge, 0, frameCount - 1);
+            }
+            else
+            {
+                _profilerFrameAge = 0;
+            }
+            _profilerFrameAge = std::clamp(_profilerFrameAge, 0, frameCount - 1);
+
+            ImGui::Separator();
+            renderFlameGraph(Profiler::GetFrame(_profilerFrameAge));
+
+            if (GpuProfiler::HasResults())
+            {
+                ImGui::Separator();
+                renderGpuTimings(Profiler::GetFrame(0));
+            }
         }
     }
     ImGui::End();
 }
 
+void Editor::renderFrameStats()
+{
+    const FrameStats::Summary summary = _frameStats->ComputeSummary();
+    if (summary.windowFrames == 0)
+        return;
+
+    ImGui::Text("Frame: p50 %.2f ms | p95 %.2f ms | p99 %.2f ms | max %.2f ms",
+        summary.p50Ms, summary.p95Ms, summary.p99Ms, summary.maxMs);
+
+    float threshold = summary.hitchThresholdMs;
+    if (ImGui::DragFloat("Hitch Threshold (ms)", &threshold, 0.5f, 1.0f, 1000.0f))
+    {
+        _frameStats->SetHitchThreshold(threshold);
+    }
+    ImGui::Text("Hitches: %llu / %llu frames", (unsigned long long)summary.hitches, (unsigned long long)summary.totalFrames);
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Reset"))
+    {
+        _frameStats->Reset();
+    }
+
+    // Last bin also holds the frames slower than the range
+    static constexpr uint32_t HISTOGRAM_BINS = 64;
+    float bins[HISTOGRAM_BINS];
+    const float rangeMs = std::max(summary.p99Ms, summary.hitchThresholdMs) * 1.25f;
+    _frameStats->ComputeHistogram(bins, HISTOGRAM_BINS, rangeMs);
+
+    char overlay[32];
+    snprintf(overlay, sizeof(overlay), "0 - %.1f ms", rangeMs);
+    ImGui::PlotHistogram("##FrameTimeHistogram", bins, HISTOGRAM_BINS, 0, overlay, 0.0f, FLT_MAX, ImVec2(-1.0f, 60.0f));
+}
+
+void Editor::renderAllocations()
+{
+    if (!AllocationTracker::IsAvailable())
+    {
+        ImGui::TextDisabled("Allocation tracking is compiled out of this build");
+        return;
+    }
+
+    bool tracking = AllocationTracker::IsEnabled();
+    if (ImGui::Checkbox("Track Allocations", &tracking))
+        AllocationTracker::SetEnabled(tracking);
+
+    const int frameCount = (int)AllocationTracker::GetFrameCount();
+    if (!tracking || frameCount == 0)
+        return;
+
+    const AllocationCounters& last = AllocationTracker::GetFrame(0);
+    ImGui::SameLine();
+    ImGui::Text("%llu allocs | %llu frees | %llu bytes",
+        (unsigned long long)last.allocations, (unsigned long long)last.frees, (unsigned long long)last.bytes);
+
+    // Allocations per frame, oldest to newest
+    float allocations[AllocationTracker::MAX_FRAMES];
+    for (int i = 0; i < frameCount; ++i)
+        allocations[i] = (float)AllocationTracker::GetFrame(frameCount - 1 - i).allocations;
+    ImGui::PlotLines("##Allocations", allocations, frameCount, 0, nullptr, 0.0f, FLT_MAX, ImVec2(-1.0f, 40.0f));
+
+    // Per scope counts come from the profiled frames
+    ImGui::InputText("Report File", &_allocationReportPath);
+    ImGui::SameLine();
+    if (ImGui::Button("Dump") && !AllocationTracker::WriteReport(_allocationReportPath))
+        std::cerr << "Failed to write the allocation report to " << _allocationReportPath << std::endl;
+}
+
+void Editor::renderFlameGraph(const ProfileFrame& frame)
+{
+    uint32_t maxDepth = 0;
+    for (uint32_t i = 0; i < frame.scopeCount; ++i)
+        maxDepth = std::max(maxDepth, frame.scopes[i].depth);
+
+    ImGui::Text("Frame #%llu: %.3f ms, %llu allocations", (unsigned long long)frame.index, frame.durationMs(),
+        (unsigned long long)frame.allocations);
+    if (frame.droppedScopes > 0)
+    {
+        ImGui::SameLine();
+        ImGui::TextDisabled("(%u scopes dropped)", frame.droppedScopes);
+    }
+
+    const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    const float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    ImGui::InvisibleButton("##FlameGraph", ImVec2(width, (maxDepth + 1) * rowHeight));
+    const bool hovered = ImGui::IsItemHovered();
+    const ImVec2 mouse = ImGui::GetIO().MousePos;
+
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const float frameDuration = (float)std::max<int64_t>(frame.end - frame.start, 1);
+
+    for (uint32_t i = 0; i < frame.scopeCount; ++i)
+    {
+        const ProfileScope& scope = frame.scopes[i];
+
+        const float x0 = origin.x + (scope.start - frame.start) / frameDuration * width;
+        const float x1 = std::max(origin.x + (scope.end - frame.start) / frameDuration * width, x0 + 1.0f);
+        const float y0 = origin.y + scope.depth * rowHeight;
+        const float y1 = y0 + rowHeight - 1.0f;
+
+        // Stable color per scope name
+        uint32_t hash = 2166136261u;
+        for (const char* c = scope.name; *c; ++c)
+            hash = (hash ^ (uint8_t)*c) * 16777619u;
+        const ImU32 color = ImColor::HSV((hash % 360) / 360.0f, 0.5f, 0.65f);
+
+        drawList->AddRectFilled(ImVec2(x0, y0), ImVec2(x1, y1), color);
+        const ImVec4 clipRect(x0, y0, x1, y1);
+        drawList->AddText(nullptr, 0.0f, ImVec2(x0 + 2.0f, y0), IM_COL32_WHITE, scope.name, nullptr, 0.0f, &clipRect);
+
+        if (hovered && mouse.x >= x0 && mouse.x < x1 && mouse.y >= y0 && mouse.y < y1)
+        {
+            ImGui::SetTooltip("%s\n%.3f ms\n%llu allocations, %llu bytes", scope.name, (scope.end - scope.start) / 1000.0f,
+                (unsigned long long)scope.allocations, (unsigned long long)scope.allocatedBytes);
+        }
+    }
+}
+
+
+void Editor::renderGpuTimings(const ProfileFrame& cpuFrame)
+{
+    const GpuFrame& gpuFrame = GpuProfiler::GetLatestFrame();
+    ImGui::Text("GPU Frame #%llu: %.3f ms", (unsigned long long)gpuFrame.index, gpuFrame.totalMs);
+
+    if (ImGui::BeginTable("##GpuPasses", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("CPU (ms)");
+        ImGui::TableSetupColumn("GPU (ms)");
+        ImGui::TableHeadersRow();
+
+        for (uint32_t i = 0; i < gpuFrame.passCount; ++i)
+        {
+            const GpuPassTiming& pass = gpuFrame.passes[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("%*s%s", (int)pass.depth * 2, "", pass.name);
+
+            // CPU scope of the same name
+            ImGui::TableNextColumn();
+            for (uint32_t s = 0; s < cpuFrame.scopeCount; ++s)
+            {
+                const ProfileScope& scope = cpuFrame.scopes[s];
+                if (strcmp(scope.name, pass.name) == 0)
+                {
+                    ImGui::Text("%.3f", (scope.end - scope.start) / 1000.0f);
+                    break;
+                }
+            }
+
+            ImGui::TableNextColumn();
+            ImGui::Text("%.3f", pass.ms);
+        }
+        ImGui::EndTable();
+    }
+
+    if (GpuProfiler::HasPipelineStatistics())
+    {
+        ImGui::Text("Vertices: %llu", (unsigned long long)gpuFrame.verticesSubmitted);
+        ImGui::Text("Primitives: %llu", (unsigned long long)gpuFrame.primitivesSubmitted);
+        ImGui::Text("Fragment invocations: %llu", (unsigned long long)gpuFrame.fragmentInvocations);
+    }
+}
 
 void Editor::setupDockspace()
 {
@@ -598,7 +1007,7 @@ void Editor::onEntitySelectedChanged()
     else if (_entitySelected.hasComponent<ParticleSystemComponent>())
     {
         _particuleSystemSelectedID = _entitySelected.getComponent<ParticleSystemComponent>().index;
-        _scene->OnParticleSystemSelected(_particuleSystemSelectedID);
+        RC_Execute([&] { _scene->OnParticleSystemSelected(_particuleSystemSelectedID); });
 
         const auto& ps = _scene->GetParticuleSystems()[_particuleSystemSelectedID];
         _particuleSystemPanel = Panel("Particule System", { { ps->GetName(), ps->GetBridge() } });
@@ -610,6 +1019,9 @@ void Editor::onEntitySelectedChanged()
         _particuleSystemSelectedID = -1;
         _pointLightSelected = nullptr;
     }
+
+    // Selection outline
+    _frameScheduler->RequestRedraw();
 }
 
 void Editor::OnEvent(Event& e)
@@ -646,6 +1058,8 @@ void Editor::nextGuizmoType()
 
 void Editor::Free()
 {
+    _worldOutliner.Free();
+
     //Shutdown ImGUI
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
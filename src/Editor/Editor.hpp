@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -13,6 +13,8 @@
 #include "../Events/Event.hpp"
 
 #include "Panel.hpp"
+#include "ViewportCache.hpp"
+#include "WorldOutliner.hpp"
 
 // TEMP
 #include "GLRenderer/Scene/Scene.hpp"
@@ -22,6 +24,8 @@
 
 
 
+struct ImDrawData;
+
 namespace oryon
 {
 
@@ -33,12 +37,22 @@ public:
 	void Initialize(GLFWwindow* window, 
 		const std::shared_ptr<class glrenderer::RendererContext>& rendererContext, 
 		const std::shared_ptr<class glrenderer::Scene>& scene,
-		const std::shared_ptr<class glrenderer::Camera>& camera);
+		const std::shared_ptr<class glrenderer::Camera>& camera,
+		const std::shared_ptr<class FrameStats>& frameStats,
+		const std::shared_ptr<class FrameScheduler>& frameScheduler,
+		const std::shared_ptr<class ClusteredLighting>& clusteredLighting);
 
 	void OnUpdate(std::shared_ptr<glrenderer::Scene>& scene);
 
 	void Draw();
 
+	// Ends the UI frame, Draw() = Render() + Submit()
+	ImDrawData* Render();
+	void Submit(ImDrawData* drawData);
+
+	// The UI is drawn by the render thread, no OpenGL call from OnUpdate
+	void SetSubmitOnRenderThread(bool enabled) { _submitOnRenderThread = enabled; }
+
 	void Free();
 
 	void OnEvent(Event& e);
@@ -47,8 +61,9 @@ public:
 
 	const glrenderer::Entity& GetEntitySelected() const { return _entitySelected; }
 
-	void SetAverageTime(float time) { _averageTime = time; }
-	bool IsProfiling() { return _profiling; }
+	// False if the render buffer of the last frame can be shown again
+	bool ShouldRenderViewport() const { return _viewportCache.NeedsRender(); }
+
 
 public:
 // Events
@@ -69,6 +84,10 @@ public:
 	using ResizeRenderBufferCallback = std::function<void(uint32_t, uint32_t)>;
 	using GetViewportBufferCallback = std::function<unsigned int()>;
 	ResizeRenderBufferCallback RC_ResizeRenderBuffer;
+
+	// Runs an OpenGL command where the context is current, waits for it
+	using ExecuteCallback = std::function<void(const std::function<void()>&)>;
+	ExecuteCallback RC_Execute = [](const std::function<void()>& command) { command(); };
 // End of events
 
 private:
@@ -78,6 +97,10 @@ private:
 	void renderLightPanel();
 	void renderMaterialPanel();
 	void renderPerformancePanel();
+	void renderFlameGraph(const struct ProfileFrame& frame);
+	void renderGpuTimings(const struct ProfileFrame& cpuFrame);
+	void renderFrameStats();
+	void renderAllocations();
 	void renderParticuleSystemPanel(std::shared_ptr<glrenderer::Scene>& scene);
 
 	void renderMenuBar();
@@ -117,8 +140,22 @@ private:
 
 	std::shared_ptr<class glrenderer::Scene> _scene = nullptr;
 
-	float _averageTime = 0.0f;
+	// Profiling
+	std::shared_ptr<class FrameStats> _frameStats = nullptr;
+	std::shared_ptr<class FrameScheduler> _frameScheduler = nullptr;
+	std::shared_ptr<class ClusteredLighting> _clusteredLighting = nullptr;
+
+	ViewportCache _viewportCache;
+
+	WorldOutliner _worldOutliner;
+
+	bool _submitOnRenderThread = false;
 	bool _profiling = false;
+	bool _profilerPaused = false;
+	int _profilerFrameAge = 0;
+	std::string _tracePath = "trace.json";
+	int _traceFrameCount = 120;
+	std::string _allocationReportPath = "allocations.json";
 };
 
 }
\ No newline at end of file
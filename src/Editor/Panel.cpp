@@ -1,6 +1,7 @@
 ﻿#include "Panel.hpp"
 
 #include "../imgui/imgui.h"
+#include "../imgui/imgui_internal.h"
 
 
 namespace oryon {
@@ -11,8 +12,12 @@ namespace oryon {
 
 	}
 
-    void Panel::render()
+    bool Panel::render()
     {
+        // Parameters are rendered by ImBridge, only ImGui knows if one of them was edited
+        const bool editedBefore = GImGui->ActiveIdHasBeenEditedThisFrame;
+        GImGui->ActiveIdHasBeenEditedThisFrame = false;
+
         if (ImGui::Begin(_label.c_str()))
         {
             for (auto& node : _nodes)
@@ -21,5 +26,9 @@ namespace oryon {
             }
         }
         ImGui::End(); 
+
+        const bool edited = GImGui->ActiveIdHasBeenEditedThisFrame;
+        GImGui->ActiveIdHasBeenEditedThisFrame |= editedBefore;
+        return edited;
     }
 }
\ No newline at end of file
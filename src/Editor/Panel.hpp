@@ -15,7 +15,8 @@ namespace oryon {
 		Panel(const std::string& label = "", const std::vector<Node>& nodes = {});
 		~Panel() = default;
 
-		void render();
+		// Returns true if a parameter was edited
+		bool render();
 
 	private:
 		std::string _label;
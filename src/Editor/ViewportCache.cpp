@@ -0,0 +1,49 @@
+#include "ViewportCache.hpp"
+
+#include "GLRenderer/Camera.hpp"
+
+namespace oryon
+{
+
+void ViewportCache::SetEnabled(bool enabled)
+{
+	_enabled = enabled;
+	_dirty = true;
+}
+
+void ViewportCache::Update(const glrenderer::Camera& camera, const glrenderer::Entity& selected)
+{
+	const glm::mat4& view = camera.getViewMatrix();
+	const glm::mat4& projection = camera.getProjectionMatrix();
+
+	// The selection is outlined by the renderer
+	_needsRender = !_enabled || _dirty || view != _view || projection != _projection || selected != _selected;
+
+	if (_needsRender)
+	{
+		_view = view;
+		_projection = projection;
+		_selected = selected;
+		++_misses;
+	}
+	else
+	{
+		++_hits;
+	}
+
+	_dirty = false;
+}
+
+float ViewportCache::GetHitRate() const
+{
+	const uint64_t frames = _hits + _misses;
+	return frames > 0 ? (float)_hits / frames : 0.0f;
+}
+
+void ViewportCache::ResetStats()
+{
+	_hits = 0;
+	_misses = 0;
+}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+
+#include "GLRenderer/Scene/Entity.hpp"
+
+namespace glrenderer { class Camera; }
+
+namespace oryon
+{
+
+/*
+* Tracks the changes visible in the viewport, the render buffer of the last frame is reused if there are none
+* The camera and the selection are compared frame to frame, scene / light / material / render settings
+* edits go through Invalidate(). Anything animated has to invalidate every frame.
+*/
+class ViewportCache
+{
+public:
+	void SetEnabled(bool enabled);
+	bool IsEnabled() const { return _enabled; }
+
+	// Something read by the renderer changed
+	void Invalidate() { _dirty = true; }
+
+	// Called once per frame after the editor updates, decides if the scene is rendered
+	void Update(const glrenderer::Camera& camera, const glrenderer::Entity& selected);
+	bool NeedsRender() const { return _needsRender; }
+
+	uint64_t GetHits() const { return _hits; }
+	uint64_t GetMisses() const { return _misses; }
+	float GetHitRate() const;
+	void ResetStats();
+
+private:
+	bool _enabled = true;
+	bool _dirty = true;
+	bool _needsRender = true;
+
+	glm::mat4 _view = glm::mat4(0.0f);
+	glm::mat4 _projection = glm::mat4(0.0f);
+	glrenderer::Entity _selected;
+
+	uint64_t _hits = 0;
+	uint64_t _misses = 0;
+};
+
+}
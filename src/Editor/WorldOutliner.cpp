@@ -0,0 +1,162 @@
+#include "WorldOutliner.hpp"
+
+#include "imgui/imgui.h"
+#include "imgui/IconsMaterialDesignIcons.h"
+
+#include "GLRenderer/Scene/Scene.hpp"
+#include "GLRenderer/Scene/Component.hpp"
+
+#include "Profiling/Profiler.hpp"
+
+namespace oryon
+{
+
+void WorldOutliner::Connect(glrenderer::Scene& scene)
+{
+	Free();
+	_scene = &scene;
+	entt::registry& registry = scene.GetScene();
+	registry.on_construct<glrenderer::LabelComponent>().connect<&WorldOutliner::onLabelConstructed>(*this);
+	registry.on_destroy<glrenderer::LabelComponent>().connect<&WorldOutliner::onLabelDestroyed>(*this);
+	_built = false;
+}
+
+void WorldOutliner::Free()
+{
+	if (!_scene)
+		return;
+
+	entt::registry& registry = _scene->GetScene();
+	registry.on_construct<glrenderer::LabelComponent>().disconnect(*this);
+	registry.on_destroy<glrenderer::LabelComponent>().disconnect(*this);
+	_scene = nullptr;
+	_rows.clear();
+	_rowIndices.clear();
+	_deadRows = 0;
+	_added.clear();
+}
+
+void WorldOutliner::Rebuild()
+{
+	ORYON_PROFILE_SCOPE("WorldOutliner::Rebuild");
+
+	_rows.clear();
+	_rowIndices.clear();
+	_deadRows = 0;
+	_added.clear();
+
+	_scene->forEachEntity([this](glrenderer::Entity entity)
+	{
+		add(entity);
+	});
+
+	_built = true;
+}
+
+void WorldOutliner::onLabelConstructed(entt::registry&, entt::entity entity)
+{
+	// The entity may not be complete yet
+	_added.push_back(entity);
+}
+
+void WorldOutliner::onLabelDestroyed(entt::registry&, entt::entity entity)
+{
+	auto it = _rowIndices.find(entity);
+	if (it == _rowIndices.end())
+		return;
+
+	// Deleting a selection or a particle system destroys many entities, the rows are removed once in compact()
+	_rows[it->second].entity = glrenderer::Entity();
+	_rowIndices.erase(it);
+	_deadRows++;
+}
+
+void WorldOutliner::compact()
+{
+	ORYON_PROFILE_SCOPE("WorldOutliner::compact");
+
+	// Keeps the order
+	size_t live = 0;
+	for (size_t i = 0; i < _rows.size(); ++i)
+	{
+		if (!_rows[i].entity)
+			continue;
+
+		if (live != i)
+		{
+			_rows[live] = std::move(_rows[i]);
+			_rowIndices[_rows[live].entity] = live;
+		}
+		live++;
+	}
+	_rows.resize(live);
+	_deadRows = 0;
+}
+
+void WorldOutliner::add(glrenderer::Entity entity)
+{
+	if (!entity || _rowIndices.count(entity) || !entity.hasComponent<glrenderer::LabelComponent>())
+		return;
+
+	_rowIndices[entity] = _rows.size();
+	_rows.push_back({ entity, "" });
+	setLabel(_rows.size() - 1);
+}
+
+void WorldOutliner::Refresh(glrenderer::Entity entity)
+{
+	auto it = _rowIndices.find(entity);
+	if (it != _rowIndices.end())
+		setLabel(it->second);
+}
+
+void WorldOutliner::setLabel(size_t row)
+{
+	_rows[row].label = std::string(ICON_MDI_CUBE) + _rows[row].entity.getComponent<glrenderer::LabelComponent>().label;
+}
+
+bool WorldOutliner::Render(const glrenderer::Entity& selected, glrenderer::Entity& clicked)
+{
+	if (!_scene)
+		return false;
+
+	if (!_built)
+		Rebuild();
+
+	if (_deadRows > 0)
+		compact();
+
+	// Entities created since the last frame
+	const entt::registry& registry = _scene->GetScene();
+	for (entt::entity entity : _added)
+	{
+		if (registry.valid(entity))
+			add(glrenderer::Entity(entity, _scene));
+	}
+	_added.clear();
+
+	bool hasClicked = false;
+
+	ImGuiListClipper clipper;
+	clipper.Begin((int)_rows.size());
+	while (clipper.Step())
+	{
+		for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
+		{
+			Row& row = _rows[i];
+
+			// Labels are not unique
+			ImGui::PushID(i);
+			if (ImGui::Selectable(row.label.c_str(), selected == row.entity))
+			{
+				clicked = row.entity;
+				hasClicked = true;
+			}
+			ImGui::PopID();
+		}
+	}
+
+	return hasClicked;
+}
+
+}
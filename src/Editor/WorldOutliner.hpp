@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "GLRenderer/Scene/Entity.hpp"
+
+namespace glrenderer { class Scene; }
+
+namespace oryon
+{
+
+/*
+* Entity list of the World Outliner
+* Labels are cached, only the visible rows are submitted to ImGui. Rows follow the LabelComponent
+* signals of the scene, whoever creates or destroys the entities (editor, import, particle systems):
+* destroyed entities lose their rows and created ones get them on the next Render().
+*/
+class WorldOutliner
+{
+public:
+	void Connect(glrenderer::Scene& scene);
+	void Free();
+
+	void Rebuild();
+
+	// The label of the entity changed
+	void Refresh(glrenderer::Entity entity);
+
+	// Returns true and sets clicked if a row was clicked this frame
+	bool Render(const glrenderer::Entity& selected, glrenderer::Entity& clicked);
+
+	size_t GetRowCount() const { return _rows.size() - _deadRows; }
+
+private:
+	void add(glrenderer::Entity entity);
+	void setLabel(size_t row);
+	void compact();
+
+	void onLabelConstructed(entt::registry& registry, entt::entity entity);
+	void onLabelDestroyed(entt::registry& registry, entt::entity entity);
+
+private:
+	struct Row
+	{
+		glrenderer::Entity entity;
+		std::string label; // with the icon
+	};
+
+	std::vector<Row> _rows = {};
+	std::unordered_map<entt::entity, size_t> _rowIndices = {};
+	size_t _deadRows = 0; // rows of destroyed entities, removed by compact()
+
+	glrenderer::Scene* _scene = nullptr;
+	std::vector<entt::entity> _added = {};
+	bool _built = false;
+};
+
+}
@@ -0,0 +1,59 @@
+#include "FrameScheduler.hpp"
+#include "Window.hpp"
+
+#include <GLFW/glfw3.h>
+#include <algorithm>
+
+namespace oryon
+{
+
+FrameScheduler::FrameScheduler(bool renderOnDemand)
+	: _renderOnDemand(renderOnDemand)
+{
+
+}
+
+void FrameScheduler::RequestRedraw(uint32_t frames)
+{
+	_pendingFrames = std::max(_pendingFrames, frames);
+}
+
+void FrameScheduler::WaitForWork(const Window& window)
+{
+	const double start = glfwGetTime();
+	GLFWwindow* nativeWindow = window.GetNativeWindow();
+
+	// Minimized: nothing is visible, sleep until restored
+	while (window.IsIconified() && !glfwWindowShouldClose(nativeWindow))
+		glfwWaitEvents();
+
+	if (_renderOnDemand)
+	{
+		// Events wake the loop up, the timeout keeps the UI alive
+		double deadline = start + _idleTimeout;
+		double now = start;
+		while (!hasWork(window) && now < deadline && !glfwWindowShouldClose(nativeWindow))
+		{
+			glfwWaitEventsTimeout(deadline - now);
+			now = glfwGetTime();
+		}
+	}
+
+	_continuous = false;
+	if (_pendingFrames > 0)
+		--_pendingFrames;
+
+	const double end = glfwGetTime();
+	const double period = end - _lastWake;
+	if (_lastWake > 0.0 && period > 0.0)
+		_idleRatio += ((float)((end - start) / period) - _idleRatio) * 0.1f;
+	_lastWake = end;
+}
+
+bool FrameScheduler::hasWork(const Window& window) const
+{
+	return _continuous || _pendingFrames > 0
+		|| glfwGetTime() - window.GetLastInputTime() < INPUT_GRACE_SECONDS;
+}
+
+}
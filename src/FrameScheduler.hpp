@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+namespace oryon
+{
+
+class Window;
+
+/*
+* Decides if the main loop has to render the next frame
+* In render on demand mode the loop blocks on the window events while nothing changes:
+* no input during the grace period, no redraw requested and nothing animating.
+* An iconified window never renders, whatever the mode.
+*/
+class FrameScheduler
+{
+public:
+	// ImGui needs a few frames after an input to settle (hover, popups, resizing)
+	static constexpr double INPUT_GRACE_SECONDS = 0.25;
+
+	FrameScheduler(bool renderOnDemand = false);
+
+	void SetRenderOnDemand(bool enabled) { _renderOnDemand = enabled; }
+	bool IsRenderOnDemand() const { return _renderOnDemand; }
+
+	// Even without events, redraw at least this often (FPS counter, async loads)
+	void SetIdleTimeout(double seconds) { _idleTimeout = seconds; }
+	double GetIdleTimeout() const { return _idleTimeout; }
+
+	// Something changed outside of the user input, render the next frames
+	void RequestRedraw(uint32_t frames = 2);
+
+	// Something is moving (animation, particles, active widget), render the next frame
+	void RequestContinuous() { _continuous = true; }
+
+	// Called before a frame starts, blocks until there is something to draw
+	void WaitForWork(const Window& window);
+
+	// Share of the wall time spent waiting, smoothed over the last frames
+	float GetIdleRatio() const { return _idleRatio; }
+
+private:
+	bool hasWork(const Window& window) const;
+
+private:
+	bool _renderOnDemand = false;
+	double _idleTimeout = 1.0;
+
+	uint32_t _pendingFrames = 0;
+	bool _continuous = false;
+
+	double _lastWake = 0.0;
+	float _idleRatio = 0.0f;
+};
+
+}
@@ -0,0 +1,198 @@
+#include "AllocationTracker.hpp"
+#include "Profiler.hpp"
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <new>
+
+namespace oryon
+{
+
+std::atomic<bool> AllocationTracker::_enabled = false;
+
+std::atomic<uint64_t> AllocationTracker::_allocations = 0;
+std::atomic<uint64_t> AllocationTracker::_frees = 0;
+std::atomic<uint64_t> AllocationTracker::_bytes = 0;
+
+AllocationCounters AllocationTracker::_frameStart = {};
+std::array<AllocationCounters, AllocationTracker::MAX_FRAMES> AllocationTracker::_frames = {};
+uint64_t AllocationTracker::_completedFrames = 0;
+
+// Plain data, constant initialized: safe to use from operator new before main
+static thread_local AllocationCounters s_threadCounters;
+
+bool AllocationTracker::IsAvailable()
+{
+#ifdef ORYON_PROFILING
+	return true;
+#else
+	return false;
+#endif
+}
+
+void AllocationTracker::OnAllocate(size_t size)
+{
+	if (!IsEnabled())
+		return;
+
+	++s_threadCounters.allocations;
+	s_threadCounters.bytes += size;
+	_allocations.fetch_add(1, std::memory_order_relaxed);
+	_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+void AllocationTracker::OnFree()
+{
+	if (!IsEnabled())
+		return;
+
+	++s_threadCounters.frees;
+	_frees.fetch_add(1, std::memory_order_relaxed);
+}
+
+void AllocationTracker::EndFrame()
+{
+	const AllocationCounters now = {
+		_allocations.load(std::memory_order_relaxed),
+		_frees.load(std::memory_order_relaxed),
+		_bytes.load(std::memory_order_relaxed)
+	};
+
+	_frames[_completedFrames % MAX_FRAMES] = now - _frameStart;
+	_frameStart = now;
+	++_completedFrames;
+}
+
+const AllocationCounters& AllocationTracker::GetFrame(uint32_t age)
+{
+	return _frames[(_completedFrames - 1 - age) % MAX_FRAMES];
+}
+
+const AllocationCounters& AllocationTracker::GetThreadCounters()
+{
+	return s_threadCounters;
+}
+
+bool AllocationTracker::WriteReport(const std::string& path)
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	out << "{\"frames\":[";
+	const uint32_t frameCount = GetFrameCount();
+	for (uint32_t i = 0; i < frameCount; ++i)
+	{
+		const AllocationCounters& frame = GetFrame(frameCount - 1 - i);
+		out << (i == 0 ? "\n" : ",\n")
+			<< "{\"allocations\":" << frame.allocations
+			<< ",\"frees\":" << frame.frees
+			<< ",\"bytes\":" << frame.bytes << "}";
+	}
+	out << "\n],\n\"scopes\":[";
+
+	// Inclusive counts summed by scope name over the profiled frames
+	struct ScopeTotal
+	{
+		uint64_t calls = 0;
+		uint64_t allocations = 0;
+		uint64_t bytes = 0;
+	};
+	std::map<std::string, ScopeTotal> scopes;
+
+	const uint32_t profiledFrames = Profiler::GetFrameCount();
+	for (uint32_t age = 0; age < profiledFrames; ++age)
+	{
+		const ProfileFrame& frame = Profiler::GetFrame(age);
+		for (uint32_t i = 0; i < frame.scopeCount; ++i)
+		{
+			ScopeTotal& total = scopes[frame.scopes[i].name];
+			++total.calls;
+			total.allocations += frame.scopes[i].allocations;
+			total.bytes += frame.scopes[i].allocatedBytes;
+		}
+	}
+
+	bool first = true;
+	for (const auto& [name, total] : scopes)
+	{
+		out << (first ? "\n" : ",\n")
+			<< "{\"name\":\"" << name << "\""
+			<< ",\"calls\":" << total.calls
+			<< ",\"allocations\":" << total.allocations
+			<< ",\"bytes\":" << total.bytes
+			<< ",\"allocations_per_frame\":" << (double)total.allocations / profiledFrames << "}";
+		first = false;
+	}
+	out << "\n]}\n";
+
+	return (bool)out;
+}
+
+}
+
+#ifdef ORYON_PROFILING
+
+/*
+* Global operator new / delete replacements
+* The aligned overloads are left to the standard library, they never reach these ones.
+*/
+void* operator new(size_t size)
+{
+	oryon::AllocationTracker::OnAllocate(size);
+	if (void* ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	oryon::AllocationTracker::OnAllocate(size);
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, tag);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	if (!ptr)
+		return;
+	oryon::AllocationTracker::OnFree();
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	operator delete(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	operator delete(ptr);
+}
+
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace oryon
+{
+
+struct AllocationCounters
+{
+	uint64_t allocations = 0;
+	uint64_t frees = 0;
+	uint64_t bytes = 0; // allocated
+
+	AllocationCounters operator-(const AllocationCounters& other) const
+	{
+		return { allocations - other.allocations, frees - other.frees, bytes - other.bytes };
+	}
+};
+
+/*
+* Counts the heap allocations made through operator new / delete
+* The global operators are replaced in profiling builds only (ORYON_PROFILING), counting can then be
+* toggled at runtime. The profiler attributes the allocations of the main thread to the active scope.
+*/
+class AllocationTracker
+{
+public:
+	static constexpr uint32_t MAX_FRAMES = 128;
+
+	// False if the operators are not replaced in this build
+	static bool IsAvailable();
+
+	static void SetEnabled(bool enabled) { _enabled.store(enabled, std::memory_order_relaxed); }
+	static bool IsEnabled() { return _enabled.load(std::memory_order_relaxed); }
+
+	// Closes the frame: allocations of all threads since the last call
+	static void EndFrame();
+
+	// Number of completed frames available (at most MAX_FRAMES)
+	static uint32_t GetFrameCount() { return _completedFrames < MAX_FRAMES ? (uint32_t)_completedFrames : MAX_FRAMES; }
+
+	// age = 0 is the last completed frame
+	static const AllocationCounters& GetFrame(uint32_t age);
+
+	// Since the start of the calling thread
+	static const AllocationCounters& GetThreadCounters();
+
+	// Frames of the tracker and scopes of the profiler frames, as JSON
+	static bool WriteReport(const std::string& path);
+
+	// Called by the replaced operators
+	static void OnAllocate(size_t size);
+	static void OnFree();
+
+private:
+	static std::atomic<bool> _enabled;
+
+	static std::atomic<uint64_t> _allocations;
+	static std::atomic<uint64_t> _frees;
+	static std::atomic<uint64_t> _bytes;
+
+	static AllocationCounters _frameStart;
+	static std::array<AllocationCounters, MAX_FRAMES> _frames;
+	static uint64_t _completedFrames;
+};
+
+}
+
+#ifdef ORYON_PROFILING
+	#define ORYON_ALLOC_END_FRAME() ::oryon::AllocationTracker::EndFrame()
+#else
+	#define ORYON_ALLOC_END_FRAME()
+#endif
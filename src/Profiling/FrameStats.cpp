@@ -0,0 +1,133 @@
+#include "FrameStats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace oryon
+{
+
+FrameStats::FrameStats(float hitchThresholdMs)
+	: _hitchThresholdMs(hitchThresholdMs)
+{
+	for (auto& sample : _samples)
+		sample.store(0.0f, std::memory_order_relaxed);
+}
+
+void FrameStats::AddFrame(float ms)
+{
+	const uint64_t index = _written.load(std::memory_order_relaxed);
+	_samples[index % WINDOW_SIZE].store(ms, std::memory_order_relaxed);
+	_written.store(index + 1, std::memory_order_release);
+
+	if (ms > GetHitchThreshold())
+		_hitches.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FrameStats::Reset()
+{
+	_written.store(0, std::memory_order_release);
+	_hitches.store(0, std::memory_order_relaxed);
+}
+
+uint32_t FrameStats::snapshot(std::array<float, WINDOW_SIZE>& samples) const
+{
+	const uint64_t written = _written.load(std::memory_order_acquire);
+	const uint32_t count = (uint32_t)std::min<uint64_t>(written, WINDOW_SIZE);
+	const uint64_t first = written - count;
+
+	for (uint32_t i = 0; i < count; ++i)
+		samples[i] = _samples[(first + i) % WINDOW_SIZE].load(std::memory_order_relaxed);
+
+	return count;
+}
+
+FrameStats::Summary FrameStats::ComputeSummary() const
+{
+	std::array<float, WINDOW_SIZE> samples;
+	const uint32_t count = snapshot(samples);
+
+	Summary summary = Summarize(samples.data(), count, GetHitchThreshold());
+	summary.totalFrames = _written.load(std::memory_order_acquire);
+	summary.hitches = GetHitchCount();
+	return summary;
+}
+
+FrameStats::Summary FrameStats::Summarize(float* samples, uint32_t count, float hitchThresholdMs)
+{
+	Summary summary;
+	summary.totalFrames = count;
+	summary.windowFrames = count;
+	summary.hitchThresholdMs = hitchThresholdMs;
+	if (count == 0)
+		return summary;
+
+	float total = 0.0f;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		total += samples[i];
+		if (samples[i] > hitchThresholdMs)
+			++summary.hitches;
+	}
+	summary.averageMs = total / count;
+
+	// Nearest-rank percentiles
+	std::sort(samples, samples + count);
+	auto percentile = [samples, count](float p) {
+		const uint32_t rank = (uint32_t)std::ceil(p * count);
+		return samples[std::clamp<uint32_t>(rank, 1, count) - 1];
+	};
+	summary.p50Ms = percentile(0.50f);
+	summary.p95Ms = percentile(0.95f);
+	summary.p99Ms = percentile(0.99f);
+	summary.maxMs = samples[count - 1];
+
+	return summary;
+}
+
+void FrameStats::ComputeHistogram(float* bins, uint32_t binCount, float maxMs) const
+{
+	std::fill(bins, bins + binCount, 0.0f);
+	if (binCount == 0 || maxMs <= 0.0f)
+		return;
+
+	std::array<float, WINDOW_SIZE> samples;
+	const uint32_t count = snapshot(samples);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		const uint32_t bin = (uint32_t)(samples[i] / maxMs * binCount);
+		bins[std::min(bin, binCount - 1)] += 1.0f;
+	}
+}
+
+void FrameStats::WriteJson(std::ostream& out) const
+{
+	WriteJson(ComputeSummary(), out);
+}
+
+void FrameStats::WriteJson(const Summary& summary, std::ostream& out)
+{
+	out << "{\"frames\":" << summary.totalFrames
+		<< ",\"window_frames\":" << summary.windowFrames
+		<< ",\"average_ms\":" << summary.averageMs
+		<< ",\"p50_ms\":" << summary.p50Ms
+		<< ",\"p95_ms\":" << summary.p95Ms
+		<< ",\"p99_ms\":" << summary.p99Ms
+		<< ",\"max_ms\":" << summary.maxMs
+		<< ",\"hitch_threshold_ms\":" << summary.hitchThresholdMs
+		<< ",\"hitches\":" << summary.hitches
+		<< "}";
+}
+
+bool FrameStats::WriteJson(const std::string& path) const
+{
+	std::ofstream out(path);
+	if (!out)
+		return false;
+
+	WriteJson(out);
+	out << "\n";
+	return true;
+}
+
+}
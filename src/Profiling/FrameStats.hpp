@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+namespace oryon
+{
+
+/*
+* Rolling window of frame times
+* A single thread adds frames, any thread can read. Samples are individual atomics so a reader
+* never blocks the producer: a summary taken while frames are added can mix two windows, never torn values.
+*/
+class FrameStats
+{
+public:
+	static constexpr uint32_t WINDOW_SIZE = 1024;
+
+	struct Summary
+	{
+		uint64_t totalFrames = 0;
+		uint32_t windowFrames = 0;
+		float averageMs = 0.0f;
+		float p50Ms = 0.0f;
+		float p95Ms = 0.0f;
+		float p99Ms = 0.0f;
+		float maxMs = 0.0f;
+		float hitchThresholdMs = 0.0f;
+		uint64_t hitches = 0;
+	};
+
+	FrameStats(float hitchThresholdMs = 33.3f);
+
+	void AddFrame(float ms);
+	void Reset();
+
+	void SetHitchThreshold(float ms) { _hitchThresholdMs.store(ms, std::memory_order_relaxed); }
+	float GetHitchThreshold() const { return _hitchThresholdMs.load(std::memory_order_relaxed); }
+	uint64_t GetHitchCount() const { return _hitches.load(std::memory_order_relaxed); }
+
+	Summary ComputeSummary() const;
+
+	// Summary of an arbitrary set of frame times, samples are sorted in place
+	static Summary Summarize(float* samples, uint32_t count, float hitchThresholdMs);
+
+	// Counts the window samples in binCount bins over [0, maxMs], the last bin also holds slower frames
+	void ComputeHistogram(float* bins, uint32_t binCount, float maxMs) const;
+
+	// Machine readable summary
+	static void WriteJson(const Summary& summary, std::ostream& out);
+	void WriteJson(std::ostream& out) const;
+	bool WriteJson(const std::string& path) const;
+
+private:
+	// Copies the window, oldest sample first, returns the number of samples
+	uint32_t snapshot(std::array<float, WINDOW_SIZE>& samples) const;
+
+private:
+	std::array<std::atomic<float>, WINDOW_SIZE> _samples;
+	std::atomic<uint64_t> _written = 0;
+	std::atomic<uint64_t> _hitches = 0;
+	std::atomic<float> _hitchThresholdMs;
+};
+
+}
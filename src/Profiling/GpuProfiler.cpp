@@ -0,0 +1,220 @@
+#include "GpuProfiler.hpp"
+
+#include <cstring>
+
+namespace oryon
+{
+
+std::array<GpuProfiler::FrameQueries, GpuProfiler::FRAMES_IN_FLIGHT> GpuProfiler::_frames = {};
+GpuFrame GpuProfiler::_latest = {};
+GpuProfiler::ResolveCallback GpuProfiler::_resolveCallback = nullptr;
+uint64_t GpuProfiler::_frameIndex = 0;
+uint32_t GpuProfiler::_depth = 0;
+bool GpuProfiler::_recording = false;
+bool GpuProfiler::_enabled = false;
+bool GpuProfiler::_initialized = false;
+bool GpuProfiler::_hasResults = false;
+bool GpuProfiler::_hasPipelineStatistics = false;
+
+namespace
+{
+	bool hasExtension(const char* name)
+	{
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; ++i)
+		{
+			if (strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+				return true;
+		}
+		return false;
+	}
+
+	constexpr GLenum STATISTIC_TARGETS[] = {
+		GL_VERTICES_SUBMITTED,
+		GL_PRIMITIVES_SUBMITTED,
+		GL_FRAGMENT_SHADER_INVOCATIONS
+	};
+}
+
+void GpuProfiler::Initialize()
+{
+	if (_initialized)
+		return;
+
+	_hasPipelineStatistics = GLAD_GL_VERSION_4_6 || hasExtension("GL_ARB_pipeline_statistics_query");
+
+	for (auto& frame : _frames)
+	{
+		glGenQueries((GLsizei)frame.timestamps.size(), frame.timestamps.data());
+		if (_hasPipelineStatistics)
+			glGenQueries((GLsizei)frame.statistics.size(), frame.statistics.data());
+	}
+
+	_initialized = true;
+}
+
+void GpuProfiler::Free()
+{
+	if (!_initialized)
+		return;
+
+	for (auto& frame : _frames)
+	{
+		glDeleteQueries((GLsizei)frame.timestamps.size(), frame.timestamps.data());
+		if (_hasPipelineStatistics)
+			glDeleteQueries((GLsizei)frame.statistics.size(), frame.statistics.data());
+		frame.pending = false;
+	}
+
+	_initialized = false;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	_recording = false;
+	_depth = 0;
+	if (!_initialized)
+		return;
+
+	resolvePending();
+
+	if (!_enabled)
+		return;
+
+	// GPU is more than FRAMES_IN_FLIGHT frames behind, do not wait for it
+	FrameQueries& frame = _frames[_frameIndex % FRAMES_IN_FLIGHT];
+	if (frame.pending)
+		return;
+
+	frame.index = _frameIndex;
+	frame.cpuStart = Profiler::Now();
+	frame.passCount = 0;
+	_recording = true;
+
+	glQueryCounter(frame.timestamps[0], GL_TIMESTAMP);
+	if (_hasPipelineStatistics)
+	{
+		for (uint32_t i = 0; i < StatisticCount; ++i)
+			glBeginQuery(STATISTIC_TARGETS[i], frame.statistics[i]);
+	}
+}
+
+void GpuProfiler::EndFrame()
+{
+	if (_recording)
+	{
+		FrameQueries& frame = _frames[_frameIndex % FRAMES_IN_FLIGHT];
+
+		if (_hasPipelineStatistics)
+		{
+			for (uint32_t i = 0; i < StatisticCount; ++i)
+				glEndQuery(STATISTIC_TARGETS[i]);
+		}
+		glQueryCounter(frame.timestamps[1], GL_TIMESTAMP);
+
+		frame.pending = true;
+		_recording = false;
+	}
+
+	++_frameIndex;
+}
+
+void GpuProfiler::Flush()
+{
+	if (!_initialized)
+		return;
+
+	glFinish();
+	resolvePending();
+}
+
+void GpuProfiler::resolvePending()
+{
+	// Resolve every finished frame, oldest first
+	for (uint32_t i = 0; i < FRAMES_IN_FLIGHT; ++i)
+	{
+		FrameQueries& frame = _frames[(_frameIndex + i) % FRAMES_IN_FLIGHT];
+		if (frame.pending && resolve(frame))
+			frame.pending = false;
+	}
+}
+
+uint32_t GpuProfiler::BeginPass(const char* name)
+{
+	if (!_recording)
+		return ~0u;
+
+	FrameQueries& frame = _frames[_frameIndex % FRAMES_IN_FLIGHT];
+	if (frame.passCount == GpuFrame::MAX_PASSES)
+		return ~0u;
+
+	const uint32_t pass = frame.passCount++;
+	frame.names[pass] = name;
+	frame.depths[pass] = _depth++;
+	glQueryCounter(frame.timestamps[2 + 2 * pass], GL_TIMESTAMP);
+	return pass;
+}
+
+void GpuProfiler::EndPass(uint32_t pass)
+{
+	if (!_recording || pass == ~0u)
+		return;
+
+	--_depth;
+	glQueryCounter(_frames[_frameIndex % FRAMES_IN_FLIGHT].timestamps[2 + 2 * pass + 1], GL_TIMESTAMP);
+}
+
+bool GpuProfiler::resolve(FrameQueries& queries)
+{
+	// The frame end timestamp is issued last, once it is available every other query is too
+	GLuint available = GL_FALSE;
+	glGetQueryObjectuiv(queries.timestamps[1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (available == GL_FALSE)
+		return false;
+
+	// Only keep the most recent frame
+	if (_hasResults && queries.index < _latest.index)
+		return true;
+
+	auto timestamp = [&queries](uint32_t query) {
+		GLuint64 value = 0;
+		glGetQueryObjectui64v(queries.timestamps[query], GL_QUERY_RESULT, &value);
+		return value;
+	};
+	auto toMs = [](GLuint64 begin, GLuint64 end) {
+		return end > begin ? (end - begin) / 1000000.0f : 0.0f;
+	};
+
+	const GLuint64 frameBegin = timestamp(0);
+	_latest.index = queries.index;
+	_latest.cpuStart = queries.cpuStart;
+	_latest.totalMs = toMs(frameBegin, timestamp(1));
+	_latest.passCount = queries.passCount;
+	for (uint32_t i = 0; i < queries.passCount; ++i)
+	{
+		const GLuint64 passBegin = timestamp(2 + 2 * i);
+		_latest.passes[i].name = queries.names[i];
+		_latest.passes[i].depth = queries.depths[i];
+		_latest.passes[i].startMs = toMs(frameBegin, passBegin);
+		_latest.passes[i].ms = toMs(passBegin, timestamp(2 + 2 * i + 1));
+	}
+
+	if (_hasPipelineStatistics)
+	{
+		GLuint64 values[StatisticCount] = {};
+		for (uint32_t i = 0; i < StatisticCount; ++i)
+			glGetQueryObjectui64v(queries.statistics[i], GL_QUERY_RESULT, &values[i]);
+
+		_latest.verticesSubmitted = values[VerticesSubmitted];
+		_latest.primitivesSubmitted = values[PrimitivesSubmitted];
+		_latest.fragmentInvocations = values[FragmentInvocations];
+	}
+
+	_hasResults = true;
+	if (_resolveCallback)
+		_resolveCallback(_latest);
+	return true;
+}
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Profiler.hpp"
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+namespace oryon
+{
+
+struct GpuPassTiming
+{
+	const char* name = nullptr;
+	uint32_t depth = 0;
+	float startMs = 0.0f; // relative to the frame start
+	float ms = 0.0f;
+};
+
+struct GpuFrame
+{
+	static constexpr uint32_t MAX_PASSES = 32;
+
+	uint64_t index = 0;
+	int64_t cpuStart = 0; // Profiler::Now() when the frame was submitted
+	float totalMs = 0.0f;
+	uint32_t passCount = 0;
+	std::array<GpuPassTiming, MAX_PASSES> passes = {};
+
+	// Pipeline statistics (only valid if GpuProfiler::HasPipelineStatistics())
+	uint64_t verticesSubmitted = 0;
+	uint64_t primitivesSubmitted = 0;
+	uint64_t fragmentInvocations = 0;
+};
+
+/*
+* GPU pass timings
+* Passes are bracketed with GL_TIMESTAMP queries so they can be nested, and the queries
+* of a frame are only read back once available, FRAMES_IN_FLIGHT frames later.
+* If every slot of the ring is still in flight, the frame is not measured instead of stalling.
+*/
+class GpuProfiler
+{
+public:
+	static constexpr uint32_t FRAMES_IN_FLIGHT = 4;
+
+	using ResolveCallback = std::function<void(const GpuFrame&)>;
+
+	static void Initialize();
+	static void Free();
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	// Blocks until every frame in flight is resolved (benchmarks, shutdown)
+	static void Flush();
+
+	// Called for every resolved frame, in submission order
+	static void SetResolveCallback(const ResolveCallback& callback) { _resolveCallback = callback; }
+
+	static uint32_t BeginPass(const char* name);
+	static void EndPass(uint32_t pass);
+
+	static void SetEnabled(bool enabled) { _enabled = enabled; }
+	static bool IsEnabled() { return _enabled; }
+
+	static bool HasPipelineStatistics() { return _hasPipelineStatistics; }
+
+	// Last frame whose queries have been resolved
+	static const GpuFrame& GetLatestFrame() { return _latest; }
+	static bool HasResults() { return _hasResults; }
+
+private:
+	enum EStatistic : uint32_t
+	{
+		VerticesSubmitted = 0,
+		PrimitivesSubmitted,
+		FragmentInvocations,
+		StatisticCount
+	};
+
+	struct FrameQueries
+	{
+		// [0] frame begin, [1] frame end, then a begin/end pair per pass
+		std::array<GLuint, 2 + 2 * GpuFrame::MAX_PASSES> timestamps = {};
+		std::array<GLuint, StatisticCount> statistics = {};
+		std::array<const char*, GpuFrame::MAX_PASSES> names = {};
+		std::array<uint32_t, GpuFrame::MAX_PASSES> depths = {};
+		uint32_t passCount = 0;
+		uint64_t index = 0;
+		int64_t cpuStart = 0;
+		bool pending = false;
+	};
+
+	static bool resolve(FrameQueries& queries);
+	static void resolvePending();
+
+private:
+	static std::array<FrameQueries, FRAMES_IN_FLIGHT> _frames;
+	static GpuFrame _latest;
+	static ResolveCallback _resolveCallback;
+	static uint64_t _frameIndex;
+	static uint32_t _depth;
+	static bool _recording;
+	static bool _enabled;
+	static bool _initialized;
+	static bool _hasResults;
+	static bool _hasPipelineStatistics;
+};
+
+class ScopedGpuProfile
+{
+public:
+	ScopedGpuProfile(const char* name) : _pass(GpuProfiler::BeginPass(name)) {}
+	~ScopedGpuProfile() { GpuProfiler::EndPass(_pass); }
+
+	ScopedGpuProfile(const ScopedGpuProfile&) = delete;
+	ScopedGpuProfile& operator=(const ScopedGpuProfile&) = delete;
+
+private:
+	uint32_t _pass;
+};
+
+}
+
+#ifdef ORYON_PROFILING
+	#define ORYON_GPU_SCOPE(name) ::oryon::ScopedGpuProfile ORYON_PROFILE_CONCAT(_gpuScope, __LINE__)(name)
+	#define ORYON_GPU_BEGIN_FRAME() ::oryon::GpuProfiler::BeginFrame()
+	#define ORYON_GPU_END_FRAME() ::oryon::GpuProfiler::EndFrame()
+#else
+	#define ORYON_GPU_SCOPE(name)
+	#define ORYON_GPU_BEGIN_FRAME()
+	#define ORYON_GPU_END_FRAME()
+#endif
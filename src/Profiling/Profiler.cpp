@@ -0,0 +1,106 @@
+#include "Profiler.hpp"
+#include "AllocationTracker.hpp"
+
+#include <chrono>
+
+namespace oryon
+{
+
+std::array<ProfileFrame, Profiler::MAX_FRAMES> Profiler::_frames = {};
+uint64_t Profiler::_completedFrames = 0;
+uint32_t Profiler::_depth = 0;
+bool Profiler::_recording = false;
+bool Profiler::_enabled = false;
+
+int64_t Profiler::Now()
+{
+	using namespace std::chrono;
+	static const steady_clock::time_point origin = steady_clock::now();
+	return duration_cast<microseconds>(steady_clock::now() - origin).count();
+}
+
+void Profiler::BeginFrame()
+{
+	// Enabling / disabling only takes effect on frame boundaries
+	_recording = _enabled;
+	_depth = 0;
+	if (!_recording)
+		return;
+
+	ProfileFrame& frame = _frames[_completedFrames % MAX_FRAMES];
+	frame.index = _completedFrames;
+	frame.start = Now();
+	frame.end = frame.start;
+	frame.scopeCount = 0;
+	frame.droppedScopes = 0;
+
+	// Counters at the start, turned into deltas when the frame ends
+	const AllocationCounters& counters = AllocationTracker::GetThreadCounters();
+	frame.allocations = counters.allocations;
+	frame.allocatedBytes = counters.bytes;
+}
+
+void Profiler::EndFrame()
+{
+	if (!_recording)
+		return;
+
+	ProfileFrame& frame = _frames[_completedFrames % MAX_FRAMES];
+	frame.end = Now();
+
+	const AllocationCounters& counters = AllocationTracker::GetThreadCounters();
+	frame.allocations = counters.allocations - frame.allocations;
+	frame.allocatedBytes = counters.bytes - frame.allocatedBytes;
+
+	++_completedFrames;
+	_recording = false;
+}
+
+uint32_t Profiler::BeginScope(const char* name)
+{
+	if (!_recording)
+		return INVALID_SCOPE;
+
+	ProfileFrame& frame = _frames[_completedFrames % MAX_FRAMES];
+	if (frame.scopeCount == ProfileFrame::MAX_SCOPES)
+	{
+		++frame.droppedScopes;
+		++_depth;
+		return INVALID_SCOPE;
+	}
+
+	ProfileScope& scope = frame.scopes[frame.scopeCount];
+	scope.name = name;
+	scope.depth = _depth++;
+	scope.start = Now();
+	scope.end = scope.start;
+
+	const AllocationCounters& counters = AllocationTracker::GetThreadCounters();
+	scope.allocations = counters.allocations;
+	scope.allocatedBytes = counters.bytes;
+	return frame.scopeCount++;
+}
+
+void Profiler::EndScope(uint32_t scope)
+{
+	if (!_recording)
+		return;
+
+	--_depth;
+	if (scope == INVALID_SCOPE)
+		return;
+
+	ProfileScope& profileScope = _frames[_completedFrames % MAX_FRAMES].scopes[scope];
+	profileScope.end = Now();
+
+	const AllocationCounters& counters = AllocationTracker::GetThreadCounters();
+	profileScope.allocations = counters.allocations - profileScope.allocations;
+	profileScope.allocatedBytes = counters.bytes - profileScope.allocatedBytes;
+}
+
+const ProfileFrame& Profiler::GetFrame(uint32_t age)
+{
+	return _frames[(_completedFrames - 1 - age) % MAX_FRAMES];
+}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace oryon
+{
+
+struct ProfileScope
+{
+	const char* name = nullptr;
+	uint32_t depth = 0;
+	int64_t start = 0; // microseconds since profiler start
+	int64_t end = 0;
+	uint64_t allocations = 0; // heap allocations inside the scope, see AllocationTracker
+	uint64_t allocatedBytes = 0;
+};
+
+struct ProfileFrame
+{
+	static constexpr uint32_t MAX_SCOPES = 128;
+
+	uint64_t index = 0;
+	int64_t start = 0;
+	int64_t end = 0;
+	uint32_t scopeCount = 0;
+	uint32_t droppedScopes = 0;
+	uint64_t allocations = 0; // main thread only
+	uint64_t allocatedBytes = 0;
+	std::array<ProfileScope, MAX_SCOPES> scopes = {};
+
+	float durationMs() const { return (end - start) / 1000.0f; }
+};
+
+/*
+* Hierarchical CPU profiler
+* Scopes are recorded in a fixed ring of frames, nothing is allocated while profiling.
+* Scope names must be string literals (or outlive the profiler).
+*/
+class Profiler
+{
+public:
+	static constexpr uint32_t MAX_FRAMES = 128;
+	static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	static uint32_t BeginScope(const char* name);
+	static void EndScope(uint32_t scope);
+
+	static void SetEnabled(bool enabled) { _enabled = enabled; }
+	static bool IsEnabled() { return _enabled; }
+
+	// Number of completed frames available (at most MAX_FRAMES)
+	static uint32_t GetFrameCount() { return _completedFrames < MAX_FRAMES ? (uint32_t)_completedFrames : MAX_FRAMES; }
+
+	// age = 0 is the last completed frame
+	static const ProfileFrame& GetFrame(uint32_t age);
+
+	// Microseconds elapsed since the profiler start
+	static int64_t Now();
+
+private:
+	static std::array<ProfileFrame, MAX_FRAMES> _frames;
+	static uint64_t _completedFrames;
+	static uint32_t _depth;
+	static bool _recording;
+	static bool _enabled;
+};
+
+class ScopedProfile
+{
+public:
+	ScopedProfile(const char* name) : _scope(Profiler::BeginScope(name)) {}
+	~ScopedProfile() { Profiler::EndScope(_scope); }
+
+	ScopedProfile(const ScopedProfile&) = delete;
+	ScopedProfile& operator=(const ScopedProfile&) = delete;
+
+private:
+	uint32_t _scope;
+};
+
+}
+
+#ifdef ORYON_PROFILING
+	#define ORYON_PROFILE_CONCAT_IMPL(a, b) a##b
+	#define ORYON_PROFILE_CONCAT(a, b) ORYON_PROFILE_CONCAT_IMPL(a, b)
+	#define ORYON_PROFILE_SCOPE(name) ::oryon::ScopedProfile ORYON_PROFILE_CONCAT(_profileScope, __LINE__)(name)
+	#define ORYON_PROFILE_BEGIN_FRAME() ::oryon::Profiler::BeginFrame()
+	#define ORYON_PROFILE_END_FRAME() ::oryon::Profiler::EndFrame()
+#else
+	#define ORYON_PROFILE_SCOPE(name)
+	#define ORYON_PROFILE_BEGIN_FRAME()
+	#define ORYON_PROFILE_END_FRAME()
+#endif
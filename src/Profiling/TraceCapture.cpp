@@ -0,0 +1,246 @@
+#include "TraceCapture.hpp"
+
+#include "Profiler.hpp"
+#include "GpuProfiler.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+namespace oryon
+{
+
+std::vector<TraceCapture::Arena*> TraceCapture::_arenas = {};
+std::mutex TraceCapture::_arenasMutex;
+std::thread TraceCapture::_writer;
+std::atomic<bool> TraceCapture::_capturing = false;
+std::atomic<bool> TraceCapture::_writing = false;
+std::string TraceCapture::_path = "";
+uint32_t TraceCapture::_remainingFrames = 0;
+int64_t TraceCapture::_startTime = 0;
+int64_t TraceCapture::_lastGpuFrame = -1;
+
+namespace
+{
+	void writeString(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (const char* c = text ? text : ""; *c; ++c)
+		{
+			if (*c == '"' || *c == '\\')
+				out << '\\';
+			out << *c;
+		}
+		out << '"';
+	}
+}
+
+TraceCapture::Arena& TraceCapture::threadArena()
+{
+	thread_local Arena* arena = nullptr;
+	if (!arena)
+	{
+		// Arenas live until the end of the program, the writer may still be reading a copy
+		static std::vector<std::unique_ptr<Arena>> storage;
+
+		std::lock_guard<std::mutex> lock(_arenasMutex);
+		storage.push_back(std::make_unique<Arena>());
+		arena = storage.back().get();
+		arena->tid = (uint32_t)storage.size(); // GPU_TID is 0
+		if (_capturing)
+			arena->events.reserve(ARENA_CAPACITY);
+		_arenas.push_back(arena);
+	}
+	return *arena;
+}
+
+bool TraceCapture::Start(const std::string& path, uint32_t frameCount)
+{
+	if (IsCapturing() || IsWriting() || frameCount == 0)
+		return false;
+
+	if (_writer.joinable())
+		_writer.join();
+
+	// Register the calling thread before reserving
+	threadArena();
+	{
+		std::lock_guard<std::mutex> lock(_arenasMutex);
+		for (Arena* arena : _arenas)
+		{
+			std::lock_guard<std::mutex> arenaLock(arena->mutex);
+			arena->events.clear();
+			arena->events.reserve(ARENA_CAPACITY);
+			arena->dropped = 0;
+		}
+	}
+
+	_path = path;
+	_remainingFrames = frameCount;
+	_startTime = Profiler::Now();
+	_lastGpuFrame = GpuProfiler::HasResults() ? (int64_t)GpuProfiler::GetLatestFrame().index : -1;
+	_capturing.store(true, std::memory_order_release);
+	return true;
+}
+
+void TraceCapture::Emit(const TraceEvent& event)
+{
+	if (!IsCapturing())
+		return;
+
+	Arena& arena = threadArena();
+	TraceEvent threadEvent = event;
+	threadEvent.tid = arena.tid;
+	append(arena, threadEvent);
+}
+
+void TraceCapture::append(Arena& arena, const TraceEvent& event)
+{
+	// Uncontended but for finish(), which takes the events from another thread
+	std::lock_guard<std::mutex> lock(arena.mutex);
+
+	// Never grow past the reserved capacity while capturing
+	if (arena.events.size() == arena.events.capacity())
+	{
+		++arena.dropped;
+		return;
+	}
+
+	arena.events.push_back(event);
+}
+
+void TraceCapture::SetThreadName(const char* name)
+{
+	Arena& arena = threadArena();
+	std::lock_guard<std::mutex> lock(arena.mutex);
+	arena.threadName = name;
+}
+
+uint32_t TraceCapture::GetThreadID()
+{
+	return threadArena().tid;
+}
+
+void TraceCapture::OnFrameEnd()
+{
+	if (!IsCapturing())
+		return;
+
+	// CPU scopes of the frame that just ended, a frame begun before Start() is not counted
+	if (Profiler::GetFrameCount() == 0 || Profiler::GetFrame(0).start < _startTime)
+		return;
+
+	const ProfileFrame& frame = Profiler::GetFrame(0);
+	Emit({ "Frame", "cpu", TraceEvent::EPhase::Complete, 0, frame.start, frame.end - frame.start });
+	for (uint32_t i = 0; i < frame.scopeCount; ++i)
+	{
+		const ProfileScope& scope = frame.scopes[i];
+		Emit({ scope.name, "cpu", TraceEvent::EPhase::Complete, 0, scope.start, scope.end - scope.start });
+	}
+	Emit({ "Frame (ms)", "counter", TraceEvent::EPhase::Counter, 0, frame.start, 0, frame.durationMs() });
+
+	// GPU passes are resolved a few frames later
+	if (GpuProfiler::HasResults() && (int64_t)GpuProfiler::GetLatestFrame().index != _lastGpuFrame)
+	{
+		const GpuFrame& gpuFrame = GpuProfiler::GetLatestFrame();
+		_lastGpuFrame = (int64_t)gpuFrame.index;
+
+		Arena& arena = threadArena();
+		append(arena, { "GPU Frame", "gpu", TraceEvent::EPhase::Complete, GPU_TID, gpuFrame.cpuStart, (int64_t)(gpuFrame.totalMs * 1000.0f) });
+		for (uint32_t i = 0; i < gpuFrame.passCount; ++i)
+		{
+			const GpuPassTiming& pass = gpuFrame.passes[i];
+			append(arena, { pass.name, "gpu", TraceEvent::EPhase::Complete, GPU_TID,
+				gpuFrame.cpuStart + (int64_t)(pass.startMs * 1000.0f), (int64_t)(pass.ms * 1000.0f) });
+		}
+
+		Emit({ "GPU (ms)", "counter", TraceEvent::EPhase::Counter, 0, gpuFrame.cpuStart, 0, gpuFrame.totalMs });
+		if (GpuProfiler::HasPipelineStatistics())
+		{
+			Emit({ "Primitives", "counter", TraceEvent::EPhase::Counter, 0, gpuFrame.cpuStart, 0, (double)gpuFrame.primitivesSubmitted });
+			Emit({ "Fragment invocations", "counter", TraceEvent::EPhase::Counter, 0, gpuFrame.cpuStart, 0, (double)gpuFrame.fragmentInvocations });
+		}
+	}
+
+	if (--_remainingFrames == 0)
+		finish();
+}
+
+void TraceCapture::finish()
+{
+	_capturing.store(false, std::memory_order_release);
+
+	// Hand the events over to the writer, the arenas are reserved again on the next capture
+	std::vector<ArenaEvents> arenas;
+	{
+		std::lock_guard<std::mutex> lock(_arenasMutex);
+		for (Arena* arena : _arenas)
+		{
+			std::lock_guard<std::mutex> arenaLock(arena->mutex);
+			arenas.push_back({ arena->tid, arena->threadName, std::move(arena->events), arena->dropped });
+			arena->events = {};
+		}
+	}
+
+	_writing.store(true, std::memory_order_release);
+	_writer = std::thread(&TraceCapture::write, _path, std::move(arenas));
+}
+
+void TraceCapture::write(const std::string& path, std::vector<ArenaEvents> arenas)
+{
+	std::ofstream out(path);
+	if (!out)
+	{
+		std::cerr << "Trace: failed to open " << path << std::endl;
+		_writing.store(false, std::memory_order_release);
+		return;
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << GPU_TID << ",\"args\":{\"name\":\"GPU\"}}";
+
+	uint32_t dropped = 0;
+	for (const ArenaEvents& arena : arenas)
+	{
+		dropped += arena.dropped;
+		if (arena.threadName)
+		{
+			out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << arena.tid << ",\"args\":{\"name\":";
+			writeString(out, arena.threadName);
+			out << "}}";
+		}
+
+		for (const TraceEvent& event : arena.events)
+		{
+			out << ",\n{\"name\":";
+			writeString(out, event.name);
+			out << ",\"cat\":";
+			writeString(out, event.category);
+			out << ",\"ph\":\"" << (char)event.phase << "\",\"pid\":1,\"tid\":" << event.tid << ",\"ts\":" << event.ts;
+
+			if (event.phase == TraceEvent::EPhase::Complete)
+				out << ",\"dur\":" << event.dur << "}";
+			else
+				out << ",\"args\":{\"value\":" << event.value << "}}";
+		}
+	}
+	out << "\n]}\n";
+
+	std::cout << "Trace written to " << path;
+	if (dropped > 0)
+		std::cout << " (" << dropped << " events dropped)";
+	std::cout << std::endl;
+
+	_writing.store(false, std::memory_order_release);
+}
+
+void TraceCapture::Free()
+{
+	if (IsCapturing())
+		finish();
+
+	if (_writer.joinable())
+		_writer.join();
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oryon
+{
+
+struct TraceEvent
+{
+	enum class EPhase : char
+	{
+		Complete = 'X',
+		Counter = 'C'
+	};
+
+	const char* name = nullptr;
+	const char* category = nullptr;
+	EPhase phase = EPhase::Complete;
+	uint32_t tid = 0;
+	int64_t ts = 0;  // microseconds
+	int64_t dur = 0; // microseconds, Complete events only
+	double value = 0.0; // Counter events only
+};
+
+/*
+* Chrome Trace Event capture (chrome://tracing, ui.perfetto.dev)
+* Events are appended to an arena owned by the emitting thread, reserved when the capture starts.
+* Once the last frame is captured, the arenas are handed to a background thread that writes the json.
+*/
+class TraceCapture
+{
+public:
+	static constexpr uint32_t ARENA_CAPACITY = 1 << 16;
+
+	// Reserved track for GPU passes
+	static constexpr uint32_t GPU_TID = 0;
+
+	static bool Start(const std::string& path, uint32_t frameCount);
+
+	// Records the last completed profiler frame, to call after ORYON_PROFILE_END_FRAME
+	static void OnFrameEnd();
+
+	// Waits for the writer thread
+	static void Free();
+
+	// event.tid is replaced by the calling thread's track
+	static void Emit(const TraceEvent& event);
+	static void SetThreadName(const char* name);
+	static uint32_t GetThreadID();
+
+	static bool IsCapturing() { return _capturing.load(std::memory_order_acquire); }
+	static bool IsWriting() { return _writing.load(std::memory_order_acquire); }
+	static uint32_t GetRemainingFrames() { return _remainingFrames; }
+	static const std::string& GetPath() { return _path; }
+
+private:
+	struct ArenaEvents
+	{
+		uint32_t tid = 0;
+		const char* threadName = nullptr;
+		std::vector<TraceEvent> events;
+		uint32_t dropped = 0;
+	};
+
+	struct Arena : ArenaEvents
+	{
+		// Held by the owning thread while appending, by finish() while taking the events
+		std::mutex mutex;
+	};
+
+	static Arena& threadArena();
+	static void append(Arena& arena, const TraceEvent& event);
+	static void finish();
+	static void write(const std::string& path, std::vector<ArenaEvents> arenas);
+
+private:
+	static std::vector<Arena*> _arenas;
+	static std::mutex _arenasMutex;
+	static std::thread _writer;
+	static std::atomic<bool> _capturing;
+	static std::atomic<bool> _writing;
+	static std::string _path;
+	static uint32_t _remainingFrames;
+	static int64_t _startTime;
+	static int64_t _lastGpuFrame;
+};
+
+}
+
+#ifdef ORYON_PROFILING
+	#define ORYON_TRACE_END_FRAME() ::oryon::TraceCapture::OnFrameEnd()
+#else
+	#define ORYON_TRACE_END_FRAME()
+#endif
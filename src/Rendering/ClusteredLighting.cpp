@@ -0,0 +1,107 @@
+#include "ClusteredLighting.hpp"
+
+#include "GLRenderer/Camera.hpp"
+#include "GLRenderer/Scene/Component.hpp"
+#include "GLRenderer/Lighting/PointLight.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace oryon
+{
+
+bool ClusteredLighting::Initialize()
+{
+	if (_initialized)
+		return true;
+
+	if (!_lightBuffer.Initialize())
+		return false;
+
+	glGenBuffers(1, &_headerBuffer);
+	glGenBuffers(1, &_clustersBuffer);
+	glGenBuffers(1, &_indicesBuffer);
+
+	_initialized = true;
+	return true;
+}
+
+void ClusteredLighting::Free()
+{
+	if (!_initialized)
+		return;
+
+	const GLuint buffers[] = { _headerBuffer, _clustersBuffer, _indicesBuffer };
+	glDeleteBuffers(3, buffers);
+	_lightBuffer.Free();
+	_initialized = false;
+}
+
+void ClusteredLighting::upload(GLuint buffer, GLuint binding, const void* data, size_t size)
+{
+	// Orphaned every frame, an empty storage buffer is not valid to bind
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(size, 16), nullptr, GL_STREAM_DRAW);
+	if (size > 0)
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, size, data);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
+}
+
+void ClusteredLighting::Update(entt::registry& registry, const glrenderer::Camera& camera)
+{
+	if (!_initialized)
+		return;
+
+	// Only the lights that changed reach the GPU
+	registry.view<glrenderer::TransformComponent, glrenderer::LightComponent>().each(
+		[this](entt::entity entity, const glrenderer::TransformComponent& transform, const glrenderer::LightComponent& component)
+	{
+		glrenderer::PointLight* pointLight = component.light ? component.light->isPointLight() : nullptr;
+		if (!pointLight)
+			return;
+
+		_lightBuffer.Set(entity, {
+			glm::vec4(transform.location, pointLight->getRadius()),
+			glm::vec4(pointLight->getColor(), pointLight->getIntensity()),
+			glm::vec4(pointLight->getLinear(), pointLight->getQuadratic(), 0.0f, 0.0f)
+		});
+	});
+	_lightBuffer.Upload();
+	_lightCount = _lightBuffer.GetCount();
+
+	Header header;
+	header.view = camera.getViewMatrix();
+	header.grid = glm::uvec4(LightClusters::GRID_X, LightClusters::GRID_Y, LightClusters::GRID_Z, _enabled ? 1u : 0u);
+	header.flags = glm::uvec4(_heatmap ? 1u : 0u, 0u, 0u, 0u);
+
+	if (!_enabled)
+	{
+		header.depth = glm::vec4(0.0f);
+		upload(_headerBuffer, HEADER_BINDING, &header, sizeof(Header));
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	// Same order as the light buffer, the cluster lists hold slots
+	_spheres.clear();
+	for (const GpuLight& light : _lightBuffer.GetLights())
+		_spheres.push_back(glm::vec4(glm::vec3(header.view * glm::vec4(glm::vec3(light.positionRadius), 1.0f)), light.positionRadius.w));
+
+	_clusters.SetProjection(camera.getProjectionMatrix());
+	_clusters.Build(_spheres);
+
+	header.depth = glm::vec4(_clusters.GetNear(), _clusters.GetFar(), _clusters.GetSliceScale(), _clusters.GetSliceBias());
+
+	upload(_headerBuffer, HEADER_BINDING, &header, sizeof(Header));
+	upload(_clustersBuffer, CLUSTERS_BINDING, _clusters.GetClusters().data(), _clusters.GetClusters().size() * sizeof(glm::uvec2));
+	upload(_indicesBuffer, INDICES_BINDING, _clusters.GetLightIndices().data(), _clusters.GetLightIndices().size() * sizeof(uint32_t));
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+	_indexCount = (uint32_t)_clusters.GetLightIndices().size();
+	_maxLightsPerCluster = _clusters.GetMaxLightsPerCluster();
+	_buildMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "LightBuffer.hpp"
+#include "LightClusters.hpp"
+
+namespace glrenderer { class Camera; }
+
+namespace oryon
+{
+
+/*
+* Point lights of the rendered registry for the lighting shaders, with clustered culling
+* The lights are kept in a LightBuffer, read by every lighting shader. The per cluster light lists
+* are rebuilt every frame for DeferredRendering/LightingPass.frag, which falls back to the plain
+* loop over all lights when clustering is disabled. The forward shaders loop over all lights.
+* Needs OpenGL 4.3.
+*/
+class ClusteredLighting
+{
+public:
+	static constexpr GLuint HEADER_BINDING = 8;
+	static constexpr GLuint CLUSTERS_BINDING = 9;
+	static constexpr GLuint INDICES_BINDING = 10;
+
+	// Creates the buffers, false if storage buffers are not supported
+	bool Initialize();
+	void Free();
+
+	// Before RenderScene, on the thread owning the context
+	void Update(entt::registry& registry, const glrenderer::Camera& camera);
+
+	bool IsAvailable() const { return _initialized; }
+
+	void SetEnabled(bool enabled) { _enabled = enabled; }
+	bool IsEnabled() const { return _enabled; }
+
+	// Lights per cluster instead of the lit scene
+	void SetHeatmap(bool enabled) { _heatmap = enabled; }
+	bool IsHeatmap() const { return _heatmap; }
+
+	// Last Update()
+	uint32_t GetLightCount() const { return _lightCount; }
+	uint32_t GetIndexCount() const { return _indexCount; }
+	uint32_t GetMaxLightsPerCluster() const { return _maxLightsPerCluster; }
+	float GetBuildMs() const { return _buildMs; }
+
+	const LightBuffer& GetLightBuffer() const { return _lightBuffer; }
+
+private:
+	// std430 layouts, must match LightingPass.frag
+	struct Header
+	{
+		glm::mat4 view;
+		glm::uvec4 grid;	// w: enabled
+		glm::vec4 depth;	// near, far, slice scale, slice bias
+		glm::uvec4 flags;	// x: heatmap
+	};
+
+	void upload(GLuint buffer, GLuint binding, const void* data, size_t size);
+
+private:
+	LightBuffer _lightBuffer;
+	LightClusters _clusters;
+	std::vector<glm::vec4> _spheres = {};
+
+	GLuint _headerBuffer = 0;
+	GLuint _clustersBuffer = 0;
+	GLuint _indicesBuffer = 0;
+	bool _initialized = false;
+
+	// Written by the editor, read by the render thread
+	std::atomic<bool> _enabled = true;
+	std::atomic<bool> _heatmap = false;
+
+	std::atomic<uint32_t> _lightCount = 0;
+	std::atomic<uint32_t> _indexCount = 0;
+	std::atomic<uint32_t> _maxLightsPerCluster = 0;
+	std::atomic<float> _buildMs = 0.0f;
+};
+
+}
@@ -0,0 +1,138 @@
+#include "FrameSnapshot.hpp"
+
+#include "GLRenderer/Scene/Scene.hpp"
+
+#include <cstring>
+
+namespace oryon
+{
+
+namespace
+{
+	// Last Apply() that found the entity in the snapshot
+	struct MirrorStamp
+	{
+		entt::entity source = entt::null;
+		uint64_t frame = 0;
+	};
+
+	// ImVector::operator= frees before copying, resize keeps the capacity
+	template<typename T>
+	void copyVector(ImVector<T>& destination, const ImVector<T>& source)
+	{
+		destination.resize(source.Size);
+		if (source.Size > 0)
+			memcpy(destination.Data, source.Data, (size_t)source.size_in_bytes());
+	}
+}
+
+void FrameSnapshot::Capture(entt::registry& registry, const glrenderer::Camera& camera, const glrenderer::Entity& selected, bool renderScene)
+{
+	_camera = camera;
+	_selected = selected ? (entt::entity)selected : entt::null;
+	_renderScene = renderScene;
+
+	_objects.clear();
+	registry.view<glrenderer::TransformComponent, glrenderer::MeshComponent>().each(
+		[this](entt::entity id, const glrenderer::TransformComponent& transform, const glrenderer::MeshComponent& mesh)
+	{
+		_objects.push_back({ id, transform, mesh });
+	});
+
+	_lights.clear();
+	registry.view<glrenderer::TransformComponent, glrenderer::LightComponent>().each(
+		[this](entt::entity id, const glrenderer::TransformComponent& transform, const glrenderer::LightComponent& light)
+	{
+		_lights.push_back({ id, transform, light });
+	});
+}
+
+void FrameSnapshot::CaptureDrawData(const ImDrawData* drawData)
+{
+	if (!drawData || !drawData->Valid)
+	{
+		_drawData.Valid = false;
+		return;
+	}
+
+	while (_drawLists.size() < (size_t)drawData->CmdListsCount)
+		_drawLists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+
+	_drawListPointers.resize(drawData->CmdListsCount);
+	for (int i = 0; i < drawData->CmdListsCount; ++i)
+	{
+		const ImDrawList& source = *drawData->CmdLists[i];
+		ImDrawList& destination = *_drawLists[i];
+		copyVector(destination.CmdBuffer, source.CmdBuffer);
+		copyVector(destination.IdxBuffer, source.IdxBuffer);
+		copyVector(destination.VtxBuffer, source.VtxBuffer);
+		destination.Flags = source.Flags;
+		_drawListPointers[i] = &destination;
+	}
+
+	_drawData = *drawData;
+	_drawData.CmdLists = _drawListPointers.data();
+}
+
+SceneMirror::SceneMirror(const std::shared_ptr<glrenderer::Scene>& scene)
+	: _scene(scene)
+{
+
+}
+
+entt::entity SceneMirror::mirror(entt::entity source, uint64_t frame)
+{
+	entt::registry& registry = _scene->GetScene();
+
+	auto it = _entities.find(source);
+	if (it == _entities.end())
+		it = _entities.emplace(source, registry.create()).first;
+
+	registry.emplace_or_replace<MirrorStamp>(it->second, source, frame);
+	return it->second;
+}
+
+void SceneMirror::Apply(const FrameSnapshot& snapshot)
+{
+	entt::registry& registry = _scene->GetScene();
+	const uint64_t frame = ++_applied;
+
+	for (const FrameSnapshot::Object& object : snapshot.GetObjects())
+	{
+		const entt::entity entity = mirror(object.id, frame);
+		registry.emplace_or_replace<glrenderer::TransformComponent>(entity, object.transform);
+		registry.emplace_or_replace<glrenderer::MeshComponent>(entity, object.mesh);
+	}
+
+	for (const FrameSnapshot::Light& light : snapshot.GetLights())
+	{
+		const entt::entity entity = mirror(light.id, frame);
+		registry.emplace_or_replace<glrenderer::TransformComponent>(entity, light.transform);
+		registry.emplace_or_replace<glrenderer::LightComponent>(entity, light.light);
+	}
+
+	// Entities gone from the editor scene
+	_stale.clear();
+	registry.view<MirrorStamp>().each([this, frame](entt::entity entity, const MirrorStamp& stamp)
+	{
+		if (stamp.frame != frame)
+			_stale.push_back(entity);
+	});
+	for (entt::entity entity : _stale)
+	{
+		_entities.erase(registry.get<MirrorStamp>(entity).source);
+		registry.destroy(entity);
+	}
+
+	auto selected = _entities.find(snapshot.GetSelected());
+	_selected = selected != _entities.end() ? selected->second : entt::null;
+}
+
+glrenderer::Entity SceneMirror::GetSelected()
+{
+	if (_selected == entt::null)
+		return glrenderer::Entity();
+	return glrenderer::Entity(_selected, _scene.get());
+}
+
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "imgui/imgui.h"
+
+#include "GLRenderer/Camera.hpp"
+#include "GLRenderer/Scene/Component.hpp"
+#include "GLRenderer/Scene/Entity.hpp"
+
+namespace glrenderer { class Scene; }
+
+namespace oryon
+{
+
+/*
+* Everything the render thread needs to draw a frame, copied by the main thread
+* Transforms are copied, meshes and lights are shared handles. The vectors keep their capacity
+* from one frame to the next, a snapshot does not allocate once the scene stops growing.
+*/
+class FrameSnapshot
+{
+public:
+	struct Object
+	{
+		entt::entity id = entt::null;
+		glrenderer::TransformComponent transform;
+		glrenderer::MeshComponent mesh;
+	};
+
+	struct Light
+	{
+		entt::entity id = entt::null;
+		glrenderer::TransformComponent transform;
+		glrenderer::LightComponent light;
+	};
+
+	void Capture(entt::registry& registry, const glrenderer::Camera& camera, const glrenderer::Entity& selected, bool renderScene);
+
+	// Copies the ImGui draw lists, the source is only valid until the next ImGui frame
+	void CaptureDrawData(const ImDrawData* drawData);
+
+	const glrenderer::Camera& GetCamera() const { return _camera; }
+	const std::vector<Object>& GetObjects() const { return _objects; }
+	const std::vector<Light>& GetLights() const { return _lights; }
+	entt::entity GetSelected() const { return _selected; }
+
+	// False if the viewport shows the render buffer of the last frame
+	bool ShouldRenderScene() const { return _renderScene; }
+
+	ImDrawData* GetDrawData() { return _drawData.Valid ? &_drawData : nullptr; }
+
+private:
+	glrenderer::Camera _camera;
+	std::vector<Object> _objects = {};
+	std::vector<Light> _lights = {};
+	entt::entity _selected = entt::null;
+	bool _renderScene = true;
+
+	std::vector<std::unique_ptr<ImDrawList>> _drawLists = {};
+	std::vector<ImDrawList*> _drawListPointers = {};
+	ImDrawData _drawData;
+};
+
+/*
+* Render thread side copy of the snapshot entities
+* The renderer reads a registry: the snapshot is applied to the one of a scene only the render
+* thread touches, the editor keeps editing its own while the frame is drawn. Particle systems are
+* not mirrored: the render thread is not started for a scene that has some, nor can one be added.
+*/
+class SceneMirror
+{
+public:
+	SceneMirror(const std::shared_ptr<glrenderer::Scene>& scene);
+
+	void Apply(const FrameSnapshot& snapshot);
+
+	glrenderer::Scene& GetScene() { return *_scene; }
+	glrenderer::Entity GetSelected();
+
+private:
+	entt::entity mirror(entt::entity source, uint64_t frame);
+
+private:
+	std::shared_ptr<glrenderer::Scene> _scene;
+
+	// Source entity -> mirror entity
+	std::unordered_map<entt::entity, entt::entity> _entities = {};
+	std::vector<entt::entity> _stale = {};
+	entt::entity _selected = entt::null;
+	uint64_t _applied = 0;
+};
+
+}
@@ -0,0 +1,160 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+#if defined(__AVX__)
+	#define ORYON_FRUSTUM_AVX
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define ORYON_FRUSTUM_SSE
+	#include <emmintrin.h>
+#endif
+
+namespace oryon
+{
+
+void BoundsArrays::Clear()
+{
+	for (std::vector<float>* values : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+		values->clear();
+}
+
+void BoundsArrays::Push(const glm::vec3& center, const glm::vec3& extent)
+{
+	centerX.push_back(center.x);
+	centerY.push_back(center.y);
+	centerZ.push_back(center.z);
+	extentX.push_back(extent.x);
+	extentY.push_back(extent.y);
+	extentZ.push_back(extent.z);
+}
+
+Frustum::Frustum(const glm::mat4& matrix, bool nearPlane)
+{
+	// Rows of the matrix: w +- x, y, z >= 0 inside the clip volume
+	const glm::mat4 rows = glm::transpose(matrix);
+	_planes[0] = rows[3] + rows[0];
+	_planes[1] = rows[3] - rows[0];
+	_planes[2] = rows[3] + rows[1];
+	_planes[3] = rows[3] - rows[1];
+	_planes[4] = rows[3] - rows[2];
+	_planes[5] = rows[3] + rows[2];
+	_planeCount = nearPlane ? 6 : 5;
+}
+
+bool Frustum::Intersects(const glm::vec3& center, const glm::vec3& extent) const
+{
+	for (uint32_t i = 0; i < _planeCount; ++i)
+	{
+		// Distance of the box corner furthest along the normal, summed in the order of the SIMD kernels
+		const glm::vec4& plane = _planes[i];
+		const float distance = plane.w + center.x * plane.x + center.y * plane.y + center.z * plane.z
+			+ extent.x * std::abs(plane.x) + extent.y * std::abs(plane.y) + extent.z * std::abs(plane.z);
+		if (distance < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool Frustum::Contains(const glm::vec3& center, const glm::vec3& extent) const
+{
+	for (uint32_t i = 0; i < _planeCount; ++i)
+	{
+		// Distance of the box corner furthest against the normal
+		const glm::vec3 normal(_planes[i]);
+		if (glm::dot(normal, center) - glm::dot(glm::abs(normal), extent) + _planes[i].w < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+void Frustum::Cull(const BoundsArrays& bounds, std::vector<uint32_t>& visible) const
+{
+	visible.clear();
+	const uint32_t count = (uint32_t)bounds.Size();
+	uint32_t first = 0;
+
+#if defined(ORYON_FRUSTUM_AVX)
+	for (; first + 8 <= count; first += 8)
+	{
+		const __m256 centerX = _mm256_loadu_ps(&bounds.centerX[first]);
+		const __m256 centerY = _mm256_loadu_ps(&bounds.centerY[first]);
+		const __m256 centerZ = _mm256_loadu_ps(&bounds.centerZ[first]);
+		const __m256 extentX = _mm256_loadu_ps(&bounds.extentX[first]);
+		const __m256 extentY = _mm256_loadu_ps(&bounds.extentY[first]);
+		const __m256 extentZ = _mm256_loadu_ps(&bounds.extentZ[first]);
+
+		__m256 outside = _mm256_setzero_ps();
+		for (uint32_t i = 0; i < _planeCount; ++i)
+		{
+			const glm::vec4& plane = _planes[i];
+			__m256 distance = _mm256_set1_ps(plane.w);
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(centerX, _mm256_set1_ps(plane.x)));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(centerY, _mm256_set1_ps(plane.y)));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(centerZ, _mm256_set1_ps(plane.z)));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(extentX, _mm256_set1_ps(std::abs(plane.x))));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(extentY, _mm256_set1_ps(std::abs(plane.y))));
+			distance = _mm256_add_ps(distance, _mm256_mul_ps(extentZ, _mm256_set1_ps(std::abs(plane.z))));
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_LT_OQ));
+		}
+
+		const int mask = _mm256_movemask_ps(outside);
+		for (int lane = 0; lane < 8; ++lane)
+		{
+			if (!(mask & (1 << lane)))
+				visible.push_back(first + lane);
+		}
+	}
+#elif defined(ORYON_FRUSTUM_SSE)
+	for (; first + 4 <= count; first += 4)
+	{
+		const __m128 centerX = _mm_loadu_ps(&bounds.centerX[first]);
+		const __m128 centerY = _mm_loadu_ps(&bounds.centerY[first]);
+		const __m128 centerZ = _mm_loadu_ps(&bounds.centerZ[first]);
+		const __m128 extentX = _mm_loadu_ps(&bounds.extentX[first]);
+		const __m128 extentY = _mm_loadu_ps(&bounds.extentY[first]);
+		const __m128 extentZ = _mm_loadu_ps(&bounds.extentZ[first]);
+
+		__m128 outside = _mm_setzero_ps();
+		for (uint32_t i = 0; i < _planeCount; ++i)
+		{
+			const glm::vec4& plane = _planes[i];
+			__m128 distance = _mm_set1_ps(plane.w);
+			distance = _mm_add_ps(distance, _mm_mul_ps(centerX, _mm_set1_ps(plane.x)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(centerY, _mm_set1_ps(plane.y)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(centerZ, _mm_set1_ps(plane.z)));
+			distance = _mm_add_ps(distance, _mm_mul_ps(extentX, _mm_set1_ps(std::abs(plane.x))));
+			distance = _mm_add_ps(distance, _mm_mul_ps(extentY, _mm_set1_ps(std::abs(plane.y))));
+			distance = _mm_add_ps(distance, _mm_mul_ps(extentZ, _mm_set1_ps(std::abs(plane.z))));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, _mm_setzero_ps()));
+		}
+
+		const int mask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			if (!(mask & (1 << lane)))
+				visible.push_back(first + lane);
+		}
+	}
+#endif
+
+	// Remainder, or every box without SIMD
+	for (; first < count; ++first)
+	{
+		if (Intersects(bounds.GetCenter(first), bounds.GetExtent(first)))
+			visible.push_back(first);
+	}
+}
+
+const char* Frustum::GetKernel()
+{
+#if defined(ORYON_FRUSTUM_AVX)
+	return "AVX";
+#elif defined(ORYON_FRUSTUM_SSE)
+	return "SSE";
+#else
+	return "scalar";
+#endif
+}
+
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace oryon
+{
+
+// World AABBs, one array per component for the culling kernels
+struct BoundsArrays
+{
+	std::vector<float> centerX = {};
+	std::vector<float> centerY = {};
+	std::vector<float> centerZ = {};
+	std::vector<float> extentX = {};
+	std::vector<float> extentY = {};
+	std::vector<float> extentZ = {};
+
+	void Clear();
+	void Push(const glm::vec3& center, const glm::vec3& extent);
+
+	size_t Size() const { return centerX.size(); }
+	glm::vec3 GetCenter(size_t i) const { return glm::vec3(centerX[i], centerY[i], centerZ[i]); }
+	glm::vec3 GetExtent(size_t i) const { return glm::vec3(extentX[i], extentY[i], extentZ[i]); }
+};
+
+/*
+* Clip planes of a projection matrix, tested against world AABBs
+* A box is culled when it is entirely behind one plane: conservative near the frustum edges, where
+* a box can be outside every plane's half space together without touching the frustum.
+* Cull() tests 8 boxes at a time with AVX, 4 with SSE, one otherwise: the kernel is chosen at
+* compile time, GetKernel() names it.
+*/
+class Frustum
+{
+public:
+	// Without the near plane, what lies in front of it is kept: the shadow passes clamp it to the map
+	explicit Frustum(const glm::mat4& matrix, bool nearPlane = true);
+
+	bool Intersects(const glm::vec3& center, const glm::vec3& extent) const;
+
+	// Entirely inside every plane
+	bool Contains(const glm::vec3& center, const glm::vec3& extent) const;
+
+	// Indices of the boxes that intersect the frustum, in order
+	void Cull(const BoundsArrays& bounds, std::vector<uint32_t>& visible) const;
+
+	static const char* GetKernel();
+
+private:
+	// Left, right, bottom, top, far, near: xyz normal pointing inside, w distance
+	glm::vec4 _planes[6] = {};
+	uint32_t _planeCount = 0;
+};
+
+}
@@ -0,0 +1,181 @@
+#include "LightBuffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace oryon
+{
+
+namespace
+{
+	// uvec4 light count before the lights
+	constexpr GLsizeiptr HEADER_SIZE = sizeof(glm::uvec4);
+	constexpr uint32_t MIN_CAPACITY = 64;
+}
+
+bool LightBuffer::Initialize()
+{
+	if (_initialized)
+		return true;
+
+	if (!GLAD_GL_VERSION_4_3)
+	{
+		std::cerr << "The light buffer needs OpenGL 4.3 shader storage buffers" << std::endl;
+		return false;
+	}
+
+	glGenBuffers(1, &_buffer);
+	_capacity = 0;
+	_countDirty = true;
+	_initialized = true;
+	return true;
+}
+
+void LightBuffer::Free()
+{
+	if (!_initialized)
+		return;
+
+	glDeleteBuffers(1, &_buffer);
+	_buffer = 0;
+	_initialized = false;
+}
+
+void LightBuffer::markDirty(uint32_t slot)
+{
+	if (_isDirty[slot])
+		return;
+
+	_isDirty[slot] = true;
+	_dirty.push_back(slot);
+}
+
+void LightBuffer::Set(entt::entity entity, const GpuLight& light)
+{
+	auto it = _slots.find(entity);
+	if (it == _slots.end())
+	{
+		const uint32_t slot = (uint32_t)_lights.size();
+		_slots.emplace(entity, slot);
+		_lights.push_back(light);
+		_entities.push_back(entity);
+		_seen.push_back(_generation);
+		_isDirty.push_back(false);
+		markDirty(slot);
+		_countDirty = true;
+		return;
+	}
+
+	const uint32_t slot = it->second;
+	_seen[slot] = _generation;
+	if (memcmp(&_lights[slot], &light, sizeof(GpuLight)) != 0)
+	{
+		_lights[slot] = light;
+		markDirty(slot);
+	}
+}
+
+void LightBuffer::remove(uint32_t slot)
+{
+	const uint32_t last = (uint32_t)_lights.size() - 1;
+	_slots.erase(_entities[slot]);
+
+	if (slot != last)
+	{
+		_lights[slot] = _lights[last];
+		_entities[slot] = _entities[last];
+		_seen[slot] = _seen[last];
+		_slots[_entities[slot]] = slot;
+		markDirty(slot);
+	}
+
+	// A stale entry of the last slot may stay in _dirty, skipped by Upload()
+	_lights.pop_back();
+	_entities.pop_back();
+	_seen.pop_back();
+	_isDirty.pop_back();
+	_countDirty = true;
+}
+
+void LightBuffer::uploadRange(uint32_t first, uint32_t count)
+{
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, HEADER_SIZE + first * sizeof(GpuLight), count * sizeof(GpuLight), &_lights[first]);
+	_uploadedBytes += count * sizeof(GpuLight);
+	++_uploadedRanges;
+}
+
+void LightBuffer::Upload()
+{
+	// From the end: the slot moved into a removed one was already checked
+	for (uint32_t slot = (uint32_t)_lights.size(); slot-- > 0;)
+	{
+		if (_seen[slot] != _generation)
+			remove(slot);
+	}
+	++_generation;
+
+	_uploadedBytes = 0;
+	_uploadedRanges = 0;
+	if (!_initialized)
+	{
+		_dirty.clear();
+		std::fill(_isDirty.begin(), _isDirty.end(), false);
+		return;
+	}
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, _buffer);
+
+	const uint32_t count = (uint32_t)_lights.size();
+	if (count > _capacity || _capacity == 0)
+	{
+		// New storage, everything is sent again
+		_capacity = std::max({ count, _capacity * 2, MIN_CAPACITY });
+		glBufferData(GL_SHADER_STORAGE_BUFFER, HEADER_SIZE + _capacity * sizeof(GpuLight), nullptr, GL_DYNAMIC_DRAW);
+		if (count > 0)
+			uploadRange(0, count);
+		_dirty.clear();
+		std::fill(_isDirty.begin(), _isDirty.end(), false);
+		_countDirty = true;
+	}
+	else if (!_dirty.empty())
+	{
+		std::sort(_dirty.begin(), _dirty.end());
+		_dirty.erase(std::unique(_dirty.begin(), _dirty.end()), _dirty.end());
+
+		uint32_t first = UINT32_MAX;
+		uint32_t last = 0;
+		for (uint32_t slot : _dirty)
+		{
+			if (slot >= count)
+				break;
+			_isDirty[slot] = false;
+
+			if (first != UINT32_MAX && slot <= last + MERGE_GAP + 1)
+			{
+				last = slot;
+				continue;
+			}
+
+			if (first != UINT32_MAX)
+				uploadRange(first, last - first + 1);
+			first = last = slot;
+		}
+		if (first != UINT32_MAX)
+			uploadRange(first, last - first + 1);
+		_dirty.clear();
+	}
+
+	if (_countDirty)
+	{
+		const glm::uvec4 header(count, 0u, 0u, 0u);
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, HEADER_SIZE, &header);
+		_uploadedBytes += HEADER_SIZE;
+		_countDirty = false;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BINDING, _buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+}
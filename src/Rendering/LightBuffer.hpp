@@ -0,0 +1,80 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <unordered_map>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+namespace oryon
+{
+
+// std430 layout, must match the LightBuffer block of the lighting shaders
+struct GpuLight
+{
+	glm::vec4 positionRadius;
+	glm::vec4 colorIntensity;
+	glm::vec4 attenuation;	// linear, quadratic
+};
+
+/*
+* Point lights of the scene in a shader storage buffer, one slot per light entity
+* The buffer grows on demand. Only the slots that changed since the last Upload() are sent,
+* neighbouring dirty slots are merged into one sub-range update. Removing a light moves the
+* last slot into its place, the slots stay packed: [0, GetCount()).
+*/
+class LightBuffer
+{
+public:
+	static constexpr GLuint BINDING = 11;
+
+	// Clean slots between two dirty ones uploaded anyway rather than splitting the update
+	static constexpr uint32_t MERGE_GAP = 4;
+
+	bool Initialize();
+	void Free();
+
+	// Every light, every frame: the lights not set since the last Upload() are removed
+	void Set(entt::entity entity, const GpuLight& light);
+
+	// Removes the missing lights, grows the buffer, uploads the dirty ranges and binds it
+	void Upload();
+
+	// Thread that uploads only, the editor reads ClusteredLighting::GetLightCount()
+	uint32_t GetCount() const { return (uint32_t)_lights.size(); }
+	const std::vector<GpuLight>& GetLights() const { return _lights; }
+
+	// Last Upload(), may be read from another thread
+	uint32_t GetCapacity() const { return _capacity; }
+	uint64_t GetUploadedBytes() const { return _uploadedBytes; }
+	uint32_t GetUploadedRanges() const { return _uploadedRanges; }
+
+private:
+	void markDirty(uint32_t slot);
+	void remove(uint32_t slot);
+	void uploadRange(uint32_t first, uint32_t count);
+
+private:
+	// Slot -> light, entity and frame it was last set
+	std::vector<GpuLight> _lights = {};
+	std::vector<entt::entity> _entities = {};
+	std::vector<uint64_t> _seen = {};
+	std::unordered_map<entt::entity, uint32_t> _slots = {};
+	uint64_t _generation = 1;
+
+	std::vector<uint32_t> _dirty = {};
+	std::vector<bool> _isDirty = {};
+	bool _countDirty = true;
+
+	GLuint _buffer = 0;
+	bool _initialized = false;
+
+	std::atomic<uint32_t> _capacity = 0;
+	std::atomic<uint64_t> _uploadedBytes = 0;
+	std::atomic<uint32_t> _uploadedRanges = 0;
+};
+
+}
@@ -0,0 +1,200 @@
+#include "LightClusters.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define ORYON_CLUSTERS_SSE
+	#include <emmintrin.h>
+#endif
+
+namespace oryon
+{
+
+void LightClusters::SetProjection(const glm::mat4& projection)
+{
+	if (projection == _projection)
+		return;
+
+	_projection = projection;
+	_near = projection[3][2] / (projection[2][2] - 1.0f);
+	_far = projection[3][2] / (projection[2][2] + 1.0f);
+
+	const float logRatio = std::log(_far / _near);
+	_sliceScale = GRID_Z / logRatio;
+	_sliceBias = -(GRID_Z * std::log(_near)) / logRatio;
+
+	buildBounds();
+}
+
+void LightClusters::buildBounds()
+{
+	// Padded: the SIMD loop reads up to 3 clusters past the end of a row
+	const size_t size = CLUSTER_COUNT + 3;
+	for (std::vector<float>* bounds : { &_minX, &_minY, &_minZ, &_maxX, &_maxY, &_maxZ })
+		bounds->assign(size, 0.0f);
+
+	// View space position of a NDC coordinate at a given distance from the camera
+	const glm::mat4& p = _projection;
+	auto viewX = [&p](float ndc, float depth) { return depth * (ndc + p[2][0]) / p[0][0]; };
+	auto viewY = [&p](float ndc, float depth) { return depth * (ndc + p[2][1]) / p[1][1]; };
+
+	for (uint32_t z = 0; z < GRID_Z; ++z)
+	{
+		const float depth0 = _near * std::pow(_far / _near, (float)z / GRID_Z);
+		const float depth1 = _near * std::pow(_far / _near, (float)(z + 1) / GRID_Z);
+
+		for (uint32_t y = 0; y < GRID_Y; ++y)
+		{
+			const float ndcY0 = -1.0f + 2.0f * y / GRID_Y;
+			const float ndcY1 = -1.0f + 2.0f * (y + 1) / GRID_Y;
+
+			for (uint32_t x = 0; x < GRID_X; ++x)
+			{
+				const float ndcX0 = -1.0f + 2.0f * x / GRID_X;
+				const float ndcX1 = -1.0f + 2.0f * (x + 1) / GRID_X;
+
+				const uint32_t cluster = (z * GRID_Y + y) * GRID_X + x;
+				_minX[cluster] = std::min({ viewX(ndcX0, depth0), viewX(ndcX0, depth1), viewX(ndcX1, depth0), viewX(ndcX1, depth1) });
+				_maxX[cluster] = std::max({ viewX(ndcX0, depth0), viewX(ndcX0, depth1), viewX(ndcX1, depth0), viewX(ndcX1, depth1) });
+				_minY[cluster] = std::min({ viewY(ndcY0, depth0), viewY(ndcY0, depth1), viewY(ndcY1, depth0), viewY(ndcY1, depth1) });
+				_maxY[cluster] = std::max({ viewY(ndcY0, depth0), viewY(ndcY0, depth1), viewY(ndcY1, depth0), viewY(ndcY1, depth1) });
+				_minZ[cluster] = -depth1;
+				_maxZ[cluster] = -depth0;
+			}
+		}
+	}
+}
+
+bool LightClusters::screenBounds(const glm::vec4& sphere, glm::uvec2& min, glm::uvec2& max) const
+{
+	glm::vec2 ndcMin(-1.0f), ndcMax(1.0f);
+
+	// Crossing the near plane: the projection of the box is unbounded, keep the whole screen
+	const float nearestDepth = -sphere.z - sphere.w;
+	if (nearestDepth > _near)
+	{
+		ndcMin = glm::vec2(FLT_MAX);
+		ndcMax = glm::vec2(-FLT_MAX);
+		const glm::mat4& p = _projection;
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const glm::vec3 point = glm::vec3(sphere) + sphere.w * glm::vec3(corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f);
+			const glm::vec2 ndc((p[0][0] * point.x + p[2][0] * point.z) / -point.z, (p[1][1] * point.y + p[2][1] * point.z) / -point.z);
+			ndcMin = glm::min(ndcMin, ndc);
+			ndcMax = glm::max(ndcMax, ndc);
+		}
+
+		if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f || ndcMin.y > 1.0f)
+			return false;
+	}
+
+	const glm::vec2 grid(GRID_X, GRID_Y);
+	const glm::vec2 tileMin = glm::clamp((ndcMin * 0.5f + 0.5f) * grid, glm::vec2(0.0f), grid - 1.0f);
+	const glm::vec2 tileMax = glm::clamp((ndcMax * 0.5f + 0.5f) * grid, glm::vec2(0.0f), grid - 1.0f);
+	min = glm::uvec2(tileMin);
+	max = glm::uvec2(tileMax);
+	return true;
+}
+
+void LightClusters::binLight(uint32_t light, const glm::vec4& sphere)
+{
+	const float depthMin = std::max(-sphere.z - sphere.w, _near);
+	const float depthMax = std::min(-sphere.z + sphere.w, _far);
+	if (depthMin > depthMax)
+		return;
+
+	glm::uvec2 tileMin, tileMax;
+	if (!screenBounds(sphere, tileMin, tileMax))
+		return;
+
+	const uint32_t sliceMin = (uint32_t)std::clamp(std::log(depthMin) * _sliceScale + _sliceBias, 0.0f, GRID_Z - 1.0f);
+	const uint32_t sliceMax = (uint32_t)std::clamp(std::log(depthMax) * _sliceScale + _sliceBias, 0.0f, GRID_Z - 1.0f);
+	const float radius2 = sphere.w * sphere.w;
+
+#ifdef ORYON_CLUSTERS_SSE
+	const __m128 centerX = _mm_set1_ps(sphere.x);
+	const __m128 centerY = _mm_set1_ps(sphere.y);
+	const __m128 centerZ = _mm_set1_ps(sphere.z);
+	const __m128 radius2x4 = _mm_set1_ps(radius2);
+	const __m128 zero = _mm_setzero_ps();
+#endif
+
+	for (uint32_t z = sliceMin; z <= sliceMax; ++z)
+	{
+		for (uint32_t y = tileMin.y; y <= tileMax.y; ++y)
+		{
+			const uint32_t row = (z * GRID_Y + y) * GRID_X;
+			for (uint32_t x = tileMin.x; x <= tileMax.x; x += 4)
+			{
+				const uint32_t first = row + x;
+#ifdef ORYON_CLUSTERS_SSE
+				// Sphere / AABB: squared distance from the center to the box
+				__m128 dx = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minX[first]), centerX), _mm_sub_ps(centerX, _mm_loadu_ps(&_maxX[first])));
+				__m128 dy = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minY[first]), centerY), _mm_sub_ps(centerY, _mm_loadu_ps(&_maxY[first])));
+				__m128 dz = _mm_max_ps(_mm_sub_ps(_mm_loadu_ps(&_minZ[first]), centerZ), _mm_sub_ps(centerZ, _mm_loadu_ps(&_maxZ[first])));
+				dx = _mm_max_ps(dx, zero);
+				dy = _mm_max_ps(dy, zero);
+				dz = _mm_max_ps(dz, zero);
+				const __m128 distance2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+				const int mask = _mm_movemask_ps(_mm_cmple_ps(distance2, radius2x4));
+#else
+				int mask = 0;
+				for (uint32_t lane = 0; lane < 4; ++lane)
+				{
+					const uint32_t cluster = first + lane;
+					const float dx = std::max({ _minX[cluster] - sphere.x, sphere.x - _maxX[cluster], 0.0f });
+					const float dy = std::max({ _minY[cluster] - sphere.y, sphere.y - _maxY[cluster], 0.0f });
+					const float dz = std::max({ _minZ[cluster] - sphere.z, sphere.z - _maxZ[cluster], 0.0f });
+					if (dx * dx + dy * dy + dz * dz <= radius2)
+						mask |= 1 << lane;
+				}
+#endif
+				const uint32_t lanes = std::min(4u, tileMax.x + 1 - x);
+				for (uint32_t lane = 0; lane < lanes; ++lane)
+				{
+					if (mask & (1 << lane))
+					{
+						_pairClusters.push_back(first + lane);
+						_pairLights.push_back(light);
+					}
+				}
+			}
+		}
+	}
+}
+
+void LightClusters::Build(const std::vector<glm::vec4>& lights)
+{
+	_pairClusters.clear();
+	_pairLights.clear();
+
+	for (uint32_t light = 0; light < (uint32_t)lights.size(); ++light)
+		binLight(light, lights[light]);
+
+	// Counting sort of the pairs by cluster, lights stay in order inside a cluster
+	for (glm::uvec2& cluster : _clusters)
+		cluster = glm::uvec2(0);
+	for (uint32_t cluster : _pairClusters)
+		++_clusters[cluster].y;
+
+	uint32_t offset = 0;
+	_maxLightsPerCluster = 0;
+	for (glm::uvec2& cluster : _clusters)
+	{
+		cluster.x = offset;
+		offset += cluster.y;
+		_maxLightsPerCluster = std::max(_maxLightsPerCluster, cluster.y);
+		cluster.y = 0;
+	}
+
+	_indices.resize(_pairLights.size());
+	for (size_t pair = 0; pair < _pairLights.size(); ++pair)
+	{
+		glm::uvec2& cluster = _clusters[_pairClusters[pair]];
+		_indices[cluster.x + cluster.y++] = _pairLights[pair];
+	}
+}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace oryon
+{
+
+/*
+* Bins point lights into view space froxels (screen tiles x exponential depth slices)
+* Each light is only tested against the clusters under its projected bounds, four clusters at a time
+* (SSE when available). The result is a compact index list: the lights of cluster c are
+* GetLightIndices()[offset, offset + count) with (offset, count) = GetClusters()[c].
+*/
+class LightClusters
+{
+public:
+	static constexpr uint32_t GRID_X = 16;
+	static constexpr uint32_t GRID_Y = 9;
+	static constexpr uint32_t GRID_Z = 24;
+	static constexpr uint32_t CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+
+	// Rebuilds the cluster bounds if the projection changed, only perspective projections are supported
+	void SetProjection(const glm::mat4& projection);
+
+	// Spheres in view space: xyz center, w radius
+	void Build(const std::vector<glm::vec4>& lights);
+
+	const std::vector<glm::uvec2>& GetClusters() const { return _clusters; }
+	const std::vector<uint32_t>& GetLightIndices() const { return _indices; }
+
+	float GetNear() const { return _near; }
+	float GetFar() const { return _far; }
+
+	// slice = log(depth) * scale + bias
+	float GetSliceScale() const { return _sliceScale; }
+	float GetSliceBias() const { return _sliceBias; }
+
+	uint32_t GetMaxLightsPerCluster() const { return _maxLightsPerCluster; }
+
+private:
+	void buildBounds();
+	void binLight(uint32_t light, const glm::vec4& sphere);
+
+	// Tile range covered by the sphere on screen, false if it is outside the frustum
+	bool screenBounds(const glm::vec4& sphere, glm::uvec2& min, glm::uvec2& max) const;
+
+private:
+	glm::mat4 _projection = glm::mat4(0.0f);
+	float _near = 0.1f;
+	float _far = 100.0f;
+	float _sliceScale = 0.0f;
+	float _sliceBias = 0.0f;
+
+	// Cluster AABBs in view space, structure of arrays
+	std::vector<float> _minX, _minY, _minZ;
+	std::vector<float> _maxX, _maxY, _maxZ;
+
+	// (cluster, light) pairs before the counting sort
+	std::vector<uint32_t> _pairClusters;
+	std::vector<uint32_t> _pairLights;
+
+	std::vector<glm::uvec2> _clusters = std::vector<glm::uvec2>(CLUSTER_COUNT);
+	std::vector<uint32_t> _indices = {};
+	uint32_t _maxLightsPerCluster = 0;
+};
+
+}
@@ -0,0 +1,120 @@
+#include "RenderThread.hpp"
+
+#include <GLFW/glfw3.h>
+#include <chrono>
+
+namespace oryon
+{
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+void RenderThread::Start(GLFWwindow* window, const RenderCallback& render)
+{
+	if (IsRunning())
+		return;
+
+	_window = window;
+	_render = render;
+	_stop = false;
+
+	glfwMakeContextCurrent(nullptr);
+	_thread = std::thread(&RenderThread::run, this);
+}
+
+void RenderThread::Stop()
+{
+	if (!IsRunning())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_condition.notify_all();
+	_thread.join();
+
+	glfwMakeContextCurrent(_window);
+}
+
+FrameSnapshot& RenderThread::BeginSnapshot()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_condition.wait(lock, [this] { return _readSlot != _writeSlot; });
+	return _snapshots[_writeSlot];
+}
+
+void RenderThread::Submit()
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_condition.wait(lock, [this] { return _pendingSlot < 0; });
+		_pendingSlot = _writeSlot;
+		_writeSlot ^= 1;
+	}
+	_condition.notify_all();
+}
+
+void RenderThread::Execute(const Command& command)
+{
+	if (!IsRunning() || std::this_thread::get_id() == _thread.get_id())
+	{
+		command();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	_command = &command;
+	_condition.notify_all();
+	_condition.wait(lock, [this] { return _command == nullptr; });
+}
+
+void RenderThread::run()
+{
+	glfwMakeContextCurrent(_window);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	while (true)
+	{
+		_condition.wait(lock, [this] { return _stop || _command || _pendingSlot >= 0; });
+
+		// The main thread is blocked in Execute, the command can touch the editor scene
+		if (_command)
+		{
+			lock.unlock();
+			(*_command)();
+			lock.lock();
+			_command = nullptr;
+			_condition.notify_all();
+			continue;
+		}
+
+		// Frames already submitted are drawn before stopping
+		if (_pendingSlot >= 0)
+		{
+			_readSlot = _pendingSlot;
+			_pendingSlot = -1;
+			lock.unlock();
+			_condition.notify_all();
+
+			const auto start = std::chrono::steady_clock::now();
+			_render(_snapshots[_readSlot]);
+			_renderMs.store(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count(),
+				std::memory_order_relaxed);
+
+			lock.lock();
+			_readSlot = -1;
+			_condition.notify_all();
+			continue;
+		}
+
+		if (_stop)
+			break;
+	}
+
+	glfwMakeContextCurrent(nullptr);
+}
+
+}
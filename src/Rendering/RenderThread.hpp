@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "FrameSnapshot.hpp"
+
+struct GLFWwindow;
+
+namespace oryon
+{
+
+/*
+* Thread that owns the OpenGL context and submits the frames
+* The main thread fills a snapshot while the render thread draws the previous one: two snapshots,
+* at most one frame in flight. Anything else touching OpenGL goes through Execute().
+*/
+class RenderThread
+{
+public:
+	using RenderCallback = std::function<void(FrameSnapshot&)>;
+	using Command = std::function<void()>;
+
+	~RenderThread();
+
+	// Takes over the context of the window, current on the calling thread
+	void Start(GLFWwindow* window, const RenderCallback& render);
+
+	// Makes the context current on the calling thread again
+	void Stop();
+
+	bool IsRunning() const { return _thread.joinable(); }
+
+	// Snapshot of the next frame, waits if the render thread is still reading it
+	FrameSnapshot& BeginSnapshot();
+
+	// Hands the snapshot over, waits if the previous one was not picked up yet
+	void Submit();
+
+	// Runs the command on the render thread between two frames and waits for it
+	// Inline if the thread is not running or from the render thread itself
+	void Execute(const Command& command);
+
+	// Duration of the last frame drawn by the render thread
+	float GetRenderMs() const { return _renderMs.load(std::memory_order_relaxed); }
+
+private:
+	void run();
+
+private:
+	GLFWwindow* _window = nullptr;
+	RenderCallback _render;
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stop = false;
+
+	std::array<FrameSnapshot, 2> _snapshots;
+	int _writeSlot = 0;
+	int _pendingSlot = -1;
+	int _readSlot = -1;
+
+	const Command* _command = nullptr;
+
+	std::atomic<float> _renderMs = 0.0f;
+};
+
+}
@@ -0,0 +1,637 @@
+#include "SceneBvh.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+
+namespace oryon
+{
+
+namespace
+{
+	// Stack entries of a subtree inside the query volume, whose leaves need no test
+	constexpr uint32_t INSIDE_BIT = 0x80000000u;
+
+	float surfaceArea(const glm::vec3& min, const glm::vec3& max)
+	{
+		const glm::vec3 size = max - min;
+		return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	bool overlaps(const glm::vec3& minA, const glm::vec3& maxA, const glm::vec3& minB, const glm::vec3& maxB)
+	{
+		return minA.x <= maxB.x && minA.y <= maxB.y && minA.z <= maxB.z
+			&& maxA.x >= minB.x && maxA.y >= minB.y && maxA.z >= minB.z;
+	}
+
+	bool reachesSphere(const glm::vec3& min, const glm::vec3& max, const glm::vec3& center, float radius)
+	{
+		const glm::vec3 offset = glm::clamp(center, min, max) - center;
+		return glm::dot(offset, offset) <= radius * radius;
+	}
+}
+
+bool SceneBvh::RayBox(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+	float maxDistance, float& distance)
+{
+	const glm::vec3 t1 = (min - origin) * inverseDirection;
+	const glm::vec3 t2 = (max - origin) * inverseDirection;
+	const glm::vec3 near = glm::min(t1, t2);
+	const glm::vec3 far = glm::max(t1, t2);
+	const float enter = std::max(std::max(near.x, near.y), std::max(near.z, 0.0f));
+	const float exit = std::min(std::min(far.x, far.y), far.z);
+	distance = enter;
+	return enter <= exit && enter <= maxDistance;
+}
+
+void SceneBvh::Clear()
+{
+	_nodes.clear();
+	_freeNodes.clear();
+	_leaves.clear();
+	_pending.clear();
+	_degraded.clear();
+	_root = NULL_NODE;
+	_leafCount = 0;
+	_pendingRefits = 0;
+	_pendingReinserts = 0;
+}
+
+uint32_t SceneBvh::allocateNode()
+{
+	if (!_freeNodes.empty())
+	{
+		const uint32_t node = _freeNodes.back();
+		_freeNodes.pop_back();
+		return node;
+	}
+
+	_nodes.emplace_back();
+	return (uint32_t)_nodes.size() - 1;
+}
+
+void SceneBvh::freeNode(uint32_t node)
+{
+	_nodes[node] = Node();
+	_freeNodes.push_back(node);
+}
+
+const SceneBvh::Leaf* SceneBvh::findLeaf(entt::entity entity) const
+{
+	const auto id = entt::entt_traits<entt::entity>::to_entity(entity);
+	if (id >= _leaves.size() || _leaves[id].node == NULL_NODE || _nodes[_leaves[id].node].entity != entity)
+		return nullptr;
+	return &_leaves[id];
+}
+
+bool SceneBvh::Contains(entt::entity entity) const
+{
+	return findLeaf(entity) != nullptr;
+}
+
+void SceneBvh::Set(entt::entity entity, const glm::vec3& center, const glm::vec3& extent)
+{
+	const auto id = entt::entt_traits<entt::entity>::to_entity(entity);
+	if (id >= _leaves.size())
+		_leaves.resize(id + 1);
+
+	// A destroyed entity whose index is reused
+	if (_leaves[id].node != NULL_NODE && _nodes[_leaves[id].node].entity != entity)
+		Remove(_nodes[_leaves[id].node].entity);
+
+	Leaf& leaf = _leaves[id];
+	leaf.center = center;
+	leaf.extent = extent;
+	leaf.min = center - extent;
+	leaf.max = center + extent;
+	const glm::vec3 margin = extent * FAT_MARGIN;
+
+	if (leaf.node == NULL_NODE)
+	{
+		const uint32_t node = allocateNode();
+		_leaves[id].node = node;
+		_nodes[node].entity = entity;
+		_nodes[node].min = _leaves[id].min - margin;
+		_nodes[node].max = _leaves[id].max + margin;
+		_pending.push_back(node);
+		++_leafCount;
+		return;
+	}
+
+	// Still inside its fat box
+	Node& node = _nodes[leaf.node];
+	if (glm::all(glm::greaterThanEqual(leaf.min, node.min)) && glm::all(glm::lessThanEqual(leaf.max, node.max)))
+		return;
+
+	// Away from its previous box, refitting would stretch the ancestors across the gap
+	const bool jumped = !overlaps(leaf.min, leaf.max, node.min, node.max);
+	node.min = leaf.min - margin;
+	node.max = leaf.max + margin;
+	if (!inTree(leaf.node))
+		return;
+
+	if (jumped)
+	{
+		detach(leaf.node);
+		_pending.push_back(leaf.node);
+		++_pendingReinserts;
+	}
+	else
+	{
+		refitAncestors(node.parent);
+		++_pendingRefits;
+	}
+}
+
+void SceneBvh::Remove(entt::entity entity)
+{
+	const Leaf* found = findLeaf(entity);
+	if (!found)
+		return;
+
+	const uint32_t node = found->node;
+	_leaves[entt::entt_traits<entt::entity>::to_entity(entity)].node = NULL_NODE;
+	--_leafCount;
+
+	if (inTree(node))
+		detach(node);
+	else
+		_pending.erase(std::find(_pending.begin(), _pending.end(), node));
+	freeNode(node);
+}
+
+void SceneBvh::detach(uint32_t leaf)
+{
+	if (leaf == _root)
+	{
+		_root = NULL_NODE;
+		return;
+	}
+
+	// The sibling takes the place of the parent
+	const uint32_t parent = _nodes[leaf].parent;
+	const uint32_t sibling = _nodes[parent].left == leaf ? _nodes[parent].right : _nodes[parent].left;
+	const uint32_t grandParent = _nodes[parent].parent;
+	_nodes[sibling].parent = grandParent;
+	if (grandParent == NULL_NODE)
+	{
+		_root = sibling;
+	}
+	else
+	{
+		replaceChild(grandParent, parent, sibling);
+		refitAncestors(grandParent);
+	}
+	freeNode(parent);
+	_nodes[leaf].parent = NULL_NODE;
+}
+
+void SceneBvh::replaceChild(uint32_t parent, uint32_t child, uint32_t replacement)
+{
+	if (_nodes[parent].left == child)
+		_nodes[parent].left = replacement;
+	else
+		_nodes[parent].right = replacement;
+}
+
+void SceneBvh::refitAncestors(uint32_t node)
+{
+	// The highest node of the path that grew too much since it was built
+	uint32_t degraded = NULL_NODE;
+	while (node != NULL_NODE)
+	{
+		Node& current = _nodes[node];
+		const glm::vec3 min = glm::min(_nodes[current.left].min, _nodes[current.right].min);
+		const glm::vec3 max = glm::max(_nodes[current.left].max, _nodes[current.right].max);
+		if (min == current.min && max == current.max)
+			break;
+
+		current.min = min;
+		current.max = max;
+		if (surfaceArea(min, max) > REBUILD_RATIO * current.builtArea)
+			degraded = node;
+		node = current.parent;
+	}
+
+	if (degraded != NULL_NODE)
+		_degraded.push_back(degraded);
+}
+
+void SceneBvh::insert(uint32_t leaf)
+{
+	if (_root == NULL_NODE)
+	{
+		_root = leaf;
+		return;
+	}
+
+	const glm::vec3 leafMin = _nodes[leaf].min;
+	const glm::vec3 leafMax = _nodes[leaf].max;
+
+	// Down the children whose area grows the least, until a new parent here is cheaper
+	uint32_t sibling = _root;
+	while (_nodes[sibling].left != NULL_NODE)
+	{
+		const Node& current = _nodes[sibling];
+		const float area = surfaceArea(current.min, current.max);
+		const float combinedArea = surfaceArea(glm::min(current.min, leafMin), glm::max(current.max, leafMax));
+		const float cost = 2.0f * combinedArea;
+		const float inheritedCost = 2.0f * (combinedArea - area);
+
+		float childCosts[2];
+		const uint32_t children[2] = { current.left, current.right };
+		for (int i = 0; i < 2; ++i)
+		{
+			const Node& child = _nodes[children[i]];
+			const float childArea = surfaceArea(glm::min(child.min, leafMin), glm::max(child.max, leafMax));
+			childCosts[i] = (child.left == NULL_NODE ? childArea : childArea - surfaceArea(child.min, child.max)) + inheritedCost;
+		}
+
+		if (cost < childCosts[0] && cost < childCosts[1])
+			break;
+		sibling = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	const uint32_t parent = allocateNode();
+	const uint32_t grandParent = _nodes[sibling].parent;
+	Node& node = _nodes[parent];
+	node.parent = grandParent;
+	node.left = sibling;
+	node.right = leaf;
+	node.min = glm::min(_nodes[sibling].min, leafMin);
+	node.max = glm::max(_nodes[sibling].max, leafMax);
+	node.builtArea = surfaceArea(node.min, node.max);
+	_nodes[sibling].parent = parent;
+	_nodes[leaf].parent = parent;
+
+	if (grandParent == NULL_NODE)
+	{
+		_root = parent;
+	}
+	else
+	{
+		replaceChild(grandParent, sibling, parent);
+		refitAncestors(grandParent);
+	}
+}
+
+void SceneBvh::collect(uint32_t node)
+{
+	// Leaves into _buildLeaves, the inner nodes are freed
+	_stack.clear();
+	_stack.push_back(node);
+	while (!_stack.empty())
+	{
+		const uint32_t current = _stack.back();
+		_stack.pop_back();
+		if (_nodes[current].left == NULL_NODE)
+		{
+			_buildLeaves.push_back(current);
+			continue;
+		}
+
+		_stack.push_back(_nodes[current].left);
+		_stack.push_back(_nodes[current].right);
+		freeNode(current);
+	}
+}
+
+void SceneBvh::rebuild(uint32_t node)
+{
+	const uint32_t parent = _nodes[node].parent;
+	_buildLeaves.clear();
+	collect(node);
+
+	const uint32_t root = build();
+	_nodes[root].parent = parent;
+	if (parent == NULL_NODE)
+		_root = root;
+	else
+		replaceChild(parent, node, root);
+
+	++_rebuiltSubtrees;
+	_rebuiltLeaves += (uint32_t)_buildLeaves.size();
+}
+
+uint32_t SceneBvh::build()
+{
+	struct Bin
+	{
+		glm::vec3 min = glm::vec3(FLT_MAX);
+		glm::vec3 max = glm::vec3(-FLT_MAX);
+		uint32_t count = 0;
+	};
+
+	// The leaf boxes side by side, partitioned in place
+	_buildItems.clear();
+	for (uint32_t leaf : _buildLeaves)
+		_buildItems.push_back({ _nodes[leaf].min, _nodes[leaf].max, (_nodes[leaf].min + _nodes[leaf].max) * 0.5f, leaf });
+
+	uint32_t root = NULL_NODE;
+	_buildTasks.clear();
+	_buildTasks.push_back({ 0, (uint32_t)_buildItems.size(), NULL_NODE, false });
+	while (!_buildTasks.empty())
+	{
+		const BuildTask task = _buildTasks.back();
+		_buildTasks.pop_back();
+
+		uint32_t node;
+		if (task.end - task.begin == 1)
+		{
+			node = _buildItems[task.begin].node;
+		}
+		else
+		{
+			const auto first = _buildItems.begin() + task.begin;
+			const auto last = _buildItems.begin() + task.end;
+			glm::vec3 min(FLT_MAX), max(-FLT_MAX), centroidMin(FLT_MAX), centroidMax(-FLT_MAX);
+			for (auto it = first; it != last; ++it)
+			{
+				min = glm::min(min, it->min);
+				max = glm::max(max, it->max);
+				centroidMin = glm::min(centroidMin, it->centroid);
+				centroidMax = glm::max(centroidMax, it->centroid);
+			}
+
+			node = allocateNode();
+			_nodes[node].min = min;
+			_nodes[node].max = max;
+			_nodes[node].builtArea = surfaceArea(min, max);
+
+			// Binned SAH along the longest axis of the centroids
+			const glm::vec3 size = centroidMax - centroidMin;
+			const int axis = size.x > size.y ? (size.x > size.z ? 0 : 2) : (size.y > size.z ? 1 : 2);
+			auto middle = first;
+			if (size[axis] > 0.0f)
+			{
+				const float scale = (float)SAH_BINS / size[axis];
+				const float offset = centroidMin[axis];
+				auto binOf = [=](const BuildItem& item) { return std::min((uint32_t)((item.centroid[axis] - offset) * scale), SAH_BINS - 1); };
+
+				Bin bins[SAH_BINS];
+				for (auto it = first; it != last; ++it)
+				{
+					Bin& bin = bins[binOf(*it)];
+					bin.min = glm::min(bin.min, it->min);
+					bin.max = glm::max(bin.max, it->max);
+					++bin.count;
+				}
+
+				// Cost of splitting after each bin: leaves times area on both sides
+				float costs[SAH_BINS - 1];
+				Bin side;
+				for (uint32_t i = 0; i < SAH_BINS - 1; ++i)
+				{
+					side.min = glm::min(side.min, bins[i].min);
+					side.max = glm::max(side.max, bins[i].max);
+					side.count += bins[i].count;
+					costs[i] = side.count ? side.count * surfaceArea(side.min, side.max) : 0.0f;
+				}
+				side = Bin();
+				for (uint32_t i = SAH_BINS - 1; i > 0; --i)
+				{
+					side.min = glm::min(side.min, bins[i].min);
+					side.max = glm::max(side.max, bins[i].max);
+					side.count += bins[i].count;
+					costs[i - 1] += side.count ? side.count * surfaceArea(side.min, side.max) : 0.0f;
+				}
+
+				uint32_t split = 0;
+				for (uint32_t i = 1; i < SAH_BINS - 1; ++i)
+				{
+					if (costs[i] < costs[split])
+						split = i;
+				}
+				middle = std::partition(first, last, [&](const BuildItem& item) { return binOf(item) <= split; });
+			}
+
+			// Every centroid in one bin: median split
+			if (middle == first || middle == last)
+			{
+				middle = first + (task.end - task.begin) / 2;
+				std::nth_element(first, middle, last, [axis](const BuildItem& a, const BuildItem& b) { return a.centroid[axis] < b.centroid[axis]; });
+			}
+
+			const uint32_t split = (uint32_t)(middle - _buildItems.begin());
+			_buildTasks.push_back({ task.begin, split, node, true });
+			_buildTasks.push_back({ split, task.end, node, false });
+		}
+
+		_nodes[node].parent = task.parent;
+		if (task.parent == NULL_NODE)
+			root = node;
+		else if (task.left)
+			_nodes[task.parent].left = node;
+		else
+			_nodes[task.parent].right = node;
+	}
+	return root;
+}
+
+void SceneBvh::Commit()
+{
+	_refits = _pendingRefits;
+	_reinserts = _pendingReinserts;
+	_pendingRefits = 0;
+	_pendingReinserts = 0;
+	_rebuiltSubtrees = 0;
+	_rebuiltLeaves = 0;
+
+	if (!_pending.empty())
+	{
+		// More new leaves than leaves in the tree: a whole build beats the inserts
+		if (_pending.size() > _leafCount - _pending.size())
+		{
+			_buildLeaves.clear();
+			if (_root != NULL_NODE)
+				collect(_root);
+			_buildLeaves.insert(_buildLeaves.end(), _pending.begin(), _pending.end());
+			_root = build();
+			_nodes[_root].parent = NULL_NODE;
+			_degraded.clear();
+			++_rebuiltSubtrees;
+			_rebuiltLeaves += (uint32_t)_buildLeaves.size();
+		}
+		else
+		{
+			for (uint32_t leaf : _pending)
+				insert(leaf);
+		}
+		_pending.clear();
+	}
+
+	// The candidates were recorded before other rebuilds, they may have been freed or rebuilt since
+	for (uint32_t node : _degraded)
+	{
+		const Node& candidate = _nodes[node];
+		if (candidate.left == NULL_NODE || !inTree(node) || surfaceArea(candidate.min, candidate.max) <= REBUILD_RATIO * candidate.builtArea)
+			continue;
+		rebuild(node);
+	}
+	_degraded.clear();
+}
+
+void SceneBvh::QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& result) const
+{
+	if (_root == NULL_NODE)
+		return;
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		const uint32_t entry = _stack.back();
+		_stack.pop_back();
+		const bool inside = (entry & INSIDE_BIT) != 0;
+		const Node& node = _nodes[entry & ~INSIDE_BIT];
+
+		if (node.left == NULL_NODE)
+		{
+			const Leaf& leaf = _leaves[entt::entt_traits<entt::entity>::to_entity(node.entity)];
+			if (inside || frustum.Intersects(leaf.center, leaf.extent))
+				result.push_back(node.entity);
+			continue;
+		}
+
+		uint32_t childBit = INSIDE_BIT;
+		if (!inside)
+		{
+			const glm::vec3 center = (node.min + node.max) * 0.5f;
+			const glm::vec3 extent = (node.max - node.min) * 0.5f;
+			if (!frustum.Intersects(center, extent))
+				continue;
+			childBit = frustum.Contains(center, extent) ? INSIDE_BIT : 0u;
+		}
+		_stack.push_back(node.left | childBit);
+		_stack.push_back(node.right | childBit);
+	}
+}
+
+void SceneBvh::QuerySphere(const glm::vec3& center, float radius, std::vector<entt::entity>& result) const
+{
+	if (_root == NULL_NODE)
+		return;
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		const Node& node = _nodes[_stack.back()];
+		_stack.pop_back();
+		if (node.left == NULL_NODE)
+		{
+			const Leaf& leaf = _leaves[entt::entt_traits<entt::entity>::to_entity(node.entity)];
+			if (reachesSphere(leaf.min, leaf.max, center, radius))
+				result.push_back(node.entity);
+		}
+		else if (reachesSphere(node.min, node.max, center, radius))
+		{
+			_stack.push_back(node.left);
+			_stack.push_back(node.right);
+		}
+	}
+}
+
+void SceneBvh::QueryBox(const glm::vec3& center, const glm::vec3& extent, std::vector<entt::entity>& result) const
+{
+	if (_root == NULL_NODE)
+		return;
+
+	const glm::vec3 min = center - extent;
+	const glm::vec3 max = center + extent;
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		const Node& node = _nodes[_stack.back()];
+		_stack.pop_back();
+		if (node.left == NULL_NODE)
+		{
+			const Leaf& leaf = _leaves[entt::entt_traits<entt::entity>::to_entity(node.entity)];
+			if (overlaps(leaf.min, leaf.max, min, max))
+				result.push_back(node.entity);
+		}
+		else if (overlaps(node.min, node.max, min, max))
+		{
+			_stack.push_back(node.left);
+			_stack.push_back(node.right);
+		}
+	}
+}
+
+bool SceneBvh::Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, entt::entity& entity, float& distance) const
+{
+	if (_root == NULL_NODE)
+		return false;
+
+	const glm::vec3 inverseDirection = 1.0f / direction;
+	float closest = maxDistance;
+	bool hit = false;
+
+	_stack.clear();
+	_stack.push_back(_root);
+	while (!_stack.empty())
+	{
+		const Node& node = _nodes[_stack.back()];
+		_stack.pop_back();
+
+		float enter;
+		if (node.left == NULL_NODE)
+		{
+			const Leaf& leaf = _leaves[entt::entt_traits<entt::entity>::to_entity(node.entity)];
+			if (RayBox(leaf.min, leaf.max, origin, inverseDirection, closest, enter))
+			{
+				closest = enter;
+				entity = node.entity;
+				hit = true;
+			}
+			continue;
+		}
+
+		// Tested again when popped, a closer hit may have been found since
+		if (!RayBox(node.min, node.max, origin, inverseDirection, closest, enter))
+			continue;
+
+		// Nearest child on top of the stack
+		float leftEnter, rightEnter;
+		const bool left = RayBox(_nodes[node.left].min, _nodes[node.left].max, origin, inverseDirection, closest, leftEnter);
+		const bool right = RayBox(_nodes[node.right].min, _nodes[node.right].max, origin, inverseDirection, closest, rightEnter);
+		if (left && right)
+		{
+			const bool leftFirst = leftEnter <= rightEnter;
+			_stack.push_back(leftFirst ? node.right : node.left);
+			_stack.push_back(leftFirst ? node.left : node.right);
+		}
+		else if (left || right)
+		{
+			_stack.push_back(left ? node.left : node.right);
+		}
+	}
+
+	if (hit)
+		distance = closest;
+	return hit;
+}
+
+uint32_t SceneBvh::GetHeight() const
+{
+	if (_root == NULL_NODE)
+		return 0;
+
+	uint32_t height = 0;
+	std::vector<std::pair<uint32_t, uint32_t>> stack = { { _root, 1u } };
+	while (!stack.empty())
+	{
+		const auto [node, depth] = stack.back();
+		stack.pop_back();
+		height = std::max(height, depth);
+		if (_nodes[node].left != NULL_NODE)
+		{
+			stack.push_back({ _nodes[node].left, depth + 1 });
+			stack.push_back({ _nodes[node].right, depth + 1 });
+		}
+	}
+	return height;
+}
+
+}
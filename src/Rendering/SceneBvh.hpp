@@ -0,0 +1,145 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include <entt/entt.hpp>
+
+#include "Frustum.hpp"
+
+namespace oryon
+{
+
+/*
+* Dynamic bounding volume hierarchy over world AABBs, one entity per leaf
+* Leaves hold their box enlarged by FAT_MARGIN: an entity moving inside it leaves the tree as is,
+* a small move out of it refits the leaf and its ancestors, a jump away reinserts the leaf at the
+* next Commit(). Refits degrade the tree, every node keeps
+* its surface area of when it was built and Commit() rebuilds, with a binned SAH, the highest
+* subtrees whose area grew past REBUILD_RATIO. Inserts wait for Commit(): more of them than leaves
+* in the tree rebuild it whole, fewer are inserted one by one where they cost the least area.
+* The queries test the exact boxes at the leaves. Not thread safe: they share a traversal stack.
+*/
+class SceneBvh
+{
+public:
+	static constexpr float FAT_MARGIN = 0.1f;		// of the extent, per axis
+	static constexpr float REBUILD_RATIO = 2.0f;
+	static constexpr uint32_t SAH_BINS = 16;
+
+	void Clear();
+
+	// Adds or moves an entity: world center and half extent
+	void Set(entt::entity entity, const glm::vec3& center, const glm::vec3& extent);
+	void Remove(entt::entity entity);
+	bool Contains(entt::entity entity) const;
+
+	// Pending inserts and degraded subtrees, before the queries of the frame
+	void Commit();
+
+	// Append the entities whose exact box reaches the volume
+	void QueryFrustum(const Frustum& frustum, std::vector<entt::entity>& result) const;
+	void QuerySphere(const glm::vec3& center, float radius, std::vector<entt::entity>& result) const;
+	void QueryBox(const glm::vec3& center, const glm::vec3& extent, std::vector<entt::entity>& result) const;
+
+	// Closest box along the ray, distance in direction units, false if none before maxDistance
+	bool Raycast(const glm::vec3& origin, const glm::vec3& direction, float maxDistance, entt::entity& entity, float& distance) const;
+
+	// Entry distance of the ray in the box, 0 from inside, false if it misses it or enters after maxDistance
+	static bool RayBox(const glm::vec3& min, const glm::vec3& max, const glm::vec3& origin, const glm::vec3& inverseDirection,
+		float maxDistance, float& distance);
+
+	uint32_t GetLeafCount() const { return _leafCount; }
+	uint32_t GetNodeCount() const { return (uint32_t)(_nodes.size() - _freeNodes.size()); }
+
+	// Longest root to leaf path, walks the tree
+	uint32_t GetHeight() const;
+
+	// Last Commit(): leaves refit and reinserted since the previous one, subtrees and leaves rebuilt
+	uint32_t GetRefits() const { return _refits; }
+	uint32_t GetReinserts() const { return _reinserts; }
+	uint32_t GetRebuiltSubtrees() const { return _rebuiltSubtrees; }
+	uint32_t GetRebuiltLeaves() const { return _rebuiltLeaves; }
+
+private:
+	static constexpr uint32_t NULL_NODE = UINT32_MAX;
+
+	struct Node
+	{
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+		uint32_t parent = NULL_NODE;
+		uint32_t left = NULL_NODE;		// NULL_NODE: leaf
+		uint32_t right = NULL_NODE;
+		float builtArea = 0.0f;
+		entt::entity entity = entt::null;
+	};
+
+	// Exact box of an entity and its leaf, center and extent as given for the frustum test
+	struct Leaf
+	{
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 extent = glm::vec3(0.0f);
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+		uint32_t node = NULL_NODE;
+	};
+
+	struct BuildItem
+	{
+		glm::vec3 min;
+		glm::vec3 max;
+		glm::vec3 centroid;
+		uint32_t node;
+	};
+
+	struct BuildTask
+	{
+		uint32_t begin;
+		uint32_t end;
+		uint32_t parent;
+		bool left;
+	};
+
+	uint32_t allocateNode();
+	void freeNode(uint32_t node);
+	const Leaf* findLeaf(entt::entity entity) const;
+	bool inTree(uint32_t node) const { return node == _root || _nodes[node].parent != NULL_NODE; }
+
+	void insert(uint32_t leaf);
+	void detach(uint32_t leaf);
+	void refitAncestors(uint32_t node);
+	void replaceChild(uint32_t parent, uint32_t child, uint32_t replacement);
+
+	// Rebuilds the subtree under node from its leaves, the new subtree takes its place
+	void rebuild(uint32_t node);
+	uint32_t build();
+	void collect(uint32_t node);
+
+private:
+	std::vector<Node> _nodes = {};
+	std::vector<uint32_t> _freeNodes = {};
+	uint32_t _root = NULL_NODE;
+	uint32_t _leafCount = 0;
+
+	// Entity index -> leaf
+	std::vector<Leaf> _leaves = {};
+
+	std::vector<uint32_t> _pending = {};
+	std::vector<uint32_t> _degraded = {};
+	std::vector<uint32_t> _buildLeaves = {};
+	std::vector<BuildItem> _buildItems = {};
+	std::vector<BuildTask> _buildTasks = {};
+	mutable std::vector<uint32_t> _stack = {};
+
+	uint32_t _pendingRefits = 0;
+	uint32_t _pendingReinserts = 0;
+	uint32_t _refits = 0;
+	uint32_t _reinserts = 0;
+	uint32_t _rebuiltSubtrees = 0;
+	uint32_t _rebuiltLeaves = 0;
+};
+
+}
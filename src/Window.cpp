@@ -1,6 +1,7 @@
 
 #include "Window.hpp"
 #include <string.h>
+#include <stdlib.h>
 #include <iostream>
 
 
@@ -48,6 +49,7 @@ namespace oryon
         glfwSetKeyCallback(_glfw_Window, [](GLFWwindow* window, int key, int scancode, int action, int mods)
         {
             WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+            data.lastInputTime = glfwGetTime();
 
             switch (action)
             {
@@ -71,11 +73,50 @@ namespace oryon
         glfwSetScrollCallback(_glfw_Window, [](GLFWwindow* window, double xOffset, double yOffset)
         {
             WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+            data.lastInputTime = glfwGetTime();
 
             MouseScrollEvent event((float)xOffset, (float)yOffset);
             data.eventCallback(event);
         });
 
+        /* Activity only, used by the render on demand mode. ImGui chains the mouse button and char callbacks */
+        glfwSetCursorPosCallback(_glfw_Window, [](GLFWwindow* window, double x, double y)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetMouseButtonCallback(_glfw_Window, [](GLFWwindow* window, int button, int action, int mods)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetCharCallback(_glfw_Window, [](GLFWwindow* window, unsigned int c)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetFramebufferSizeCallback(_glfw_Window, [](GLFWwindow* window, int width, int height)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetWindowFocusCallback(_glfw_Window, [](GLFWwindow* window, int focused)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetWindowRefreshCallback(_glfw_Window, [](GLFWwindow* window)
+        {
+            ((WindowData*)glfwGetWindowUserPointer(window))->lastInputTime = glfwGetTime();
+        });
+
+        glfwSetWindowIconifyCallback(_glfw_Window, [](GLFWwindow* window, int iconified)
+        {
+            WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+            data.iconified = iconified == GLFW_TRUE;
+            data.lastInputTime = glfwGetTime();
+        });
+
         return 1;
     }
 
@@ -90,6 +131,18 @@ namespace oryon
         {
             if (strcmp(argv[i], "-hd") == 0 || strcmp(argv[i], "-fhd") == 0)
                 InitScreenSize(argv[i]);
+            else if (strcmp(argv[i], "--trace") == 0 && i + 1 < (size_t)argc)
+                _tracePath = argv[++i];
+            else if (strcmp(argv[i], "--trace-frames") == 0 && i + 1 < (size_t)argc)
+                _traceFrames = (unsigned int)atoi(argv[++i]);
+            else if (strcmp(argv[i], "--stats") == 0 && i + 1 < (size_t)argc)
+                _statsPath = argv[++i];
+            else if (strcmp(argv[i], "--hitch-ms") == 0 && i + 1 < (size_t)argc)
+                _hitchThreshold = (float)atof(argv[++i]);
+            else if (strcmp(argv[i], "--on-demand") == 0)
+                _renderOnDemand = true;
+            else if (strcmp(argv[i], "--render-thread") == 0)
+                _renderThread = true;
         }
     }
 
@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <functional>
+#include <string>
 
 #include "Events/Event.hpp"
 
@@ -19,7 +20,25 @@ namespace oryon
         unsigned int Width() const { return _windowData.width; }
         unsigned int Height() const { return _windowData.height; }
 
-        GLFWwindow* GetNativeWindow() { return _glfw_Window; }
+        GLFWwindow* GetNativeWindow() const { return _glfw_Window; }
+
+        // glfwGetTime() of the last input or window event
+        double GetLastInputTime() const { return _windowData.lastInputTime; }
+        bool IsIconified() const { return _windowData.iconified; }
+
+        // --trace out.json [--trace-frames N]
+        const std::string& GetTracePath() const { return _tracePath; }
+        unsigned int GetTraceFrames() const { return _traceFrames; }
+
+        // --stats out.json [--hitch-ms X]
+        const std::string& GetStatsPath() const { return _statsPath; }
+        float GetHitchThreshold() const { return _hitchThreshold; }
+
+        // --on-demand
+        bool IsRenderOnDemand() const { return _renderOnDemand; }
+
+        // --render-thread
+        bool UseRenderThread() const { return _renderThread; }
 
         int Init();
 
@@ -35,11 +54,21 @@ namespace oryon
             unsigned int width = 1920;
             unsigned int height = 1080;
 
+            double lastInputTime = 0.0;
+            bool iconified = false;
+
             EventCallback eventCallback;
         };
 
         WindowData _windowData;
 
+        std::string _tracePath = "";
+        unsigned int _traceFrames = 300;
+        std::string _statsPath = "";
+        float _hitchThreshold = 33.3f;
+        bool _renderOnDemand = false;
+        bool _renderThread = false;
+
     };
 
 }   // ns oryon